@@ -0,0 +1,344 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+
+#include "LimitOrderBook.h"
+#include "Clock.h"
+
+using BenchClock = std::chrono::steady_clock;
+
+static constexpr Ticks MidTicks = 2000;
+static constexpr int OrdersPerLevel = 4;
+static constexpr Volume OrderVolume = 10;
+
+//Results of queries land here so the optimizer can't drop them
+static volatile long benchSink = 0;
+
+struct BenchResult
+{
+    std::string name;
+    int depth;
+    std::vector<long long> samples;
+};
+
+static void printHeader()
+{
+    std::cout << std::left << std::setw(28) << "benchmark" << std::right
+        << std::setw(8) << "depth" << std::setw(10) << "ops"
+        << std::setw(10) << "mean" << std::setw(10) << "p50" << std::setw(10) << "p90"
+        << std::setw(10) << "p99" << std::setw(10) << "p99.9" << "   (ns/op)" << std::endl;
+}
+
+static void printResult(BenchResult& result)
+{
+    auto& samples = result.samples;
+    std::sort(samples.begin(), samples.end());
+
+    auto percentile = [&](double p) {
+        size_t idx = static_cast<size_t>(p * (samples.size() - 1));
+        return samples[idx];
+    };
+
+    long double sum = 0;
+    for (long long s : samples) sum += s;
+
+    std::cout << std::left << std::setw(28) << result.name << std::right
+        << std::setw(8) << result.depth << std::setw(10) << samples.size()
+        << std::setw(10) << static_cast<long long>(sum / samples.size())
+        << std::setw(10) << percentile(0.50) << std::setw(10) << percentile(0.90)
+        << std::setw(10) << percentile(0.99) << std::setw(10) << percentile(0.999) << std::endl;
+}
+
+//Times op() once per sample; setup() and teardown() run outside the timed region
+static BenchResult run(const std::string& name, int depth, int ops,
+    const std::function<void()>& setup, const std::function<void()>& op, const std::function<void()>& teardown)
+{
+    BenchResult result{ name, depth, {} };
+    result.samples.reserve(ops);
+
+    for (int i = 0; i < ops; i++)
+    {
+        setup();
+        auto start = BenchClock::now();
+        op();
+        auto end = BenchClock::now();
+        teardown();
+
+        result.samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+
+    return result;
+}
+
+static Order benchOrder(Side side, Ticks price, Volume volume)
+{
+    return { 0, 1, price, volume, side, 0 };
+}
+
+//depth levels per side, OrdersPerLevel resting orders each, one tick apart around MidTicks
+static void fillBook(LimitOrderBook& LOB, Clock& clock, int depth, std::vector<OrderId>* ids = nullptr)
+{
+    for (int level = 0; level < depth; level++)
+    {
+        for (int i = 0; i < OrdersPerLevel; i++)
+        {
+            OrderId bidId = LOB.processOrder(benchOrder(BUY, MidTicks - 1 - level, OrderVolume), clock);
+            OrderId askId = LOB.processOrder(benchOrder(SELL, MidTicks + 1 + level, OrderVolume), clock);
+            if (ids)
+            {
+                ids->push_back(bidId);
+                ids->push_back(askId);
+            }
+        }
+    }
+}
+
+static void benchPassiveInsert(int depth, int ops)
+{
+    LimitOrderBook LOB;
+    Clock clock;
+    fillBook(LOB, clock, depth);
+
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> levelDist(0, depth - 1);
+
+    Order order{};
+    OrderId id = 0;
+
+    BenchResult result = run("processOrder/passive", depth, ops,
+        [&] {
+            Side side = (rng() & 1) ? BUY : SELL;
+            Ticks price = (side == BUY) ? MidTicks - 1 - levelDist(rng) : MidTicks + 1 + levelDist(rng);
+            order = benchOrder(side, price, OrderVolume);
+        },
+        [&] { id = LOB.processOrder(order, clock); },
+        [&] { LOB.cancelOrder(id); });
+
+    printResult(result);
+}
+
+static void benchSweep(int depth, int levels, int ops)
+{
+    if (levels > depth) return;
+
+    LimitOrderBook LOB;
+    Clock clock;
+    fillBook(LOB, clock, depth);
+
+    Order sweep{};
+
+    BenchResult result = run("processOrder/sweep" + std::to_string(levels), depth, ops,
+        [&] { sweep = benchOrder(BUY, MidTicks + levels, OrderVolume * OrdersPerLevel * levels); },
+        [&] { LOB.processOrder(sweep, clock); },
+        [&] {
+            for (int level = 0; level < levels; level++)
+                for (int i = 0; i < OrdersPerLevel; i++)
+                    LOB.processOrder(benchOrder(SELL, MidTicks + 1 + level, OrderVolume), clock);
+        });
+
+    printResult(result);
+}
+
+static void benchCancel(int depth, int ops, bool hit)
+{
+    LimitOrderBook LOB;
+    Clock clock;
+    std::vector<OrderId> ids;
+    fillBook(LOB, clock, depth, &ids);
+
+    std::mt19937 rng(2);
+    size_t pick = 0;
+    Order replacement{};
+
+    BenchResult result = run(hit ? "cancelOrder/hit" : "cancelOrder/miss", depth, ops,
+        [&] { pick = rng() % ids.size(); },
+        [&] {
+            if (hit) LOB.cancelOrder(ids[pick]);
+            else LOB.cancelOrder(0x7fffffff - static_cast<OrderId>(pick));
+        },
+        [&] {
+            if (!hit) return;
+
+            //Repost on the same side so the book keeps its shape
+            Side side = (pick % 2 == 0) ? BUY : SELL;
+            int level = static_cast<int>(pick / (2 * OrdersPerLevel));
+            replacement = benchOrder(side, (side == BUY) ? MidTicks - 1 - level : MidTicks + 1 + level, OrderVolume);
+            ids[pick] = LOB.processOrder(replacement, clock);
+        });
+
+    printResult(result);
+}
+
+static void benchAddLimitOrder(int depth, int ops)
+{
+    LimitOrderBook LOB;
+    Clock clock;
+    fillBook(LOB, clock, depth);
+
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> levelDist(0, depth - 1);
+
+    //Ids well clear of the ones processOrder hands out
+    OrderId nextId = 1u << 30;
+    Order order{};
+
+    BenchResult result = run("addLimitOrder", depth, ops,
+        [&] {
+            Side side = (rng() & 1) ? BUY : SELL;
+            Ticks price = (side == BUY) ? MidTicks - 1 - levelDist(rng) : MidTicks + 1 + levelDist(rng);
+            order = benchOrder(side, price, OrderVolume);
+            order.id = nextId++;
+        },
+        [&] { LOB.addLimitOrder(order); },
+        [&] { LOB.cancelOrder(order.id); });
+
+    printResult(result);
+}
+
+//One trader replacing its two-sided quote: cancel + two new orders against a single massQuote
+static void benchRequote(int depth, int ops, bool massQuote, bool samePrice)
+{
+    LimitOrderBook LOB;
+    Clock clock;
+    fillBook(LOB, clock, depth);
+
+    std::mt19937 rng(4);
+    std::uniform_int_distribution<int> levelDist(0, depth - 1);
+
+    const TraderId quoter = 2;
+    OrderId bidId = 0;
+    OrderId askId = 0;
+    Volume volume = 1 << 30; //Shrinks by one per op so a same-price amend keeps its priority
+    Order bid{};
+    Order ask{};
+
+    std::string name = massQuote ? "massQuote" : "requote/cancel+new";
+    name += samePrice ? "/resize" : "/reprice";
+
+    BenchResult result = run(name, depth, ops,
+        [&] {
+            int level = samePrice ? 0 : levelDist(rng);
+            volume--;
+            bid = benchOrder(BUY, MidTicks - 1 - level, volume);
+            ask = benchOrder(SELL, MidTicks + 1 + level, volume);
+            bid.traderId = quoter;
+            ask.traderId = quoter;
+        },
+        [&] {
+            if (massQuote)
+            {
+                LOB.massQuote(quoter, bid, ask, clock);
+                return;
+            }
+            LOB.cancelOrder(bidId);
+            LOB.cancelOrder(askId);
+            bidId = LOB.processOrder(bid, clock);
+            askId = LOB.processOrder(ask, clock);
+        },
+        [] {});
+
+    printResult(result);
+}
+
+//A burst of passive orders spread over a few levels, one call per order against one batch
+static void benchBurst(int depth, int ops, bool batched)
+{
+    static constexpr size_t BurstSize = 64;
+
+    LimitOrderBook LOB;
+    Clock clock;
+    fillBook(LOB, clock, depth);
+
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> levelDist(0, std::min(depth, 8) - 1);
+
+    std::vector<Command> burst(BurstSize);
+    std::vector<CommandResult> results(BurstSize);
+
+    BenchResult result = run(batched ? "processBatch/burst64" : "processOrder/burst64", depth, ops,
+        [&] {
+            for (Command& command : burst)
+            {
+                Side side = (rng() & 1) ? BUY : SELL;
+                Ticks price = (side == BUY) ? MidTicks - 1 - levelDist(rng) : MidTicks + 1 + levelDist(rng);
+                command = makeOrderCommand(benchOrder(side, price, OrderVolume), false);
+            }
+        },
+        [&] {
+            if (batched)
+            {
+                LOB.processBatch(burst.data(), burst.size(), results.data(), clock);
+                return;
+            }
+            for (size_t i = 0; i < burst.size(); i++) results[i].orderId = LOB.processOrder(burst[i].order, clock);
+        },
+        [&] { for (const CommandResult& placed : results) LOB.cancelOrder(placed.orderId); });
+
+    printResult(result);
+}
+
+static void benchDepthQueries(int depth, int ops)
+{
+    LimitOrderBook LOB;
+    Clock clock;
+    fillBook(LOB, clock, depth);
+
+    long totalVolume = 0;
+
+    BenchResult depthResult = run("depthChartPoints", depth, ops,
+        [] {},
+        [&] { benchSink = static_cast<long>(LOB.depthChartPoints(0.5f, &totalVolume).size()); },
+        [] {});
+    printResult(depthResult);
+
+    BenchResult volumeResult = run("getHighestVolume/25", depth, ops,
+        [] {},
+        [&] { benchSink = LOB.getHighestVolume(BUY, 25) + LOB.getHighestVolume(SELL, 25); },
+        [] {});
+    printResult(volumeResult);
+
+    LevelInfo top[25];
+    BenchResult topResult = run("getTopLevels/25 into buffer", depth, ops,
+        [] {},
+        [&] { benchSink = static_cast<long>(LOB.getTopLevels(BUY, top, 25) + LOB.getTopLevels(SELL, top, 25)); },
+        [] {});
+    printResult(topResult);
+}
+
+int main(int argc, char** argv)
+{
+    int ops = (argc > 1) ? std::stoi(argv[1]) : 100000;
+
+#ifdef MARKETSIM_MAP_BOOK
+    std::cout << "Book levels: std::map" << std::endl;
+#else
+    std::cout << "Book levels: price ladder" << std::endl;
+#endif
+
+    printHeader();
+
+    for (int depth : { 10, 100, 1000 })
+    {
+        benchPassiveInsert(depth, ops);
+        benchSweep(depth, 1, ops);
+        benchSweep(depth, 10, ops);
+        benchSweep(depth, 100, ops / 10);
+        benchCancel(depth, ops, true);
+        benchCancel(depth, ops, false);
+        benchAddLimitOrder(depth, ops);
+        benchRequote(depth, ops, false, false);
+        benchRequote(depth, ops, true, false);
+        benchRequote(depth, ops, false, true);
+        benchRequote(depth, ops, true, true);
+        benchBurst(depth, ops / 10, false);
+        benchBurst(depth, ops / 10, true);
+        benchDepthQueries(depth, ops / 10);
+    }
+
+    return 0;
+}
\ No newline at end of file
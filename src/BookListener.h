@@ -0,0 +1,32 @@
+#pragma once
+
+#include "datatypes.h"
+
+enum class LevelChange : uint8_t
+{
+	Added,
+	Changed,
+	Removed
+};
+
+//New state of one price level. Removed carries zero volume and orders.
+struct LevelDelta
+{
+	Side side;
+	LevelChange change;
+	Ticks price;
+	long volume;
+	uint32_t orderCount;
+};
+
+//L2 feed of a LimitOrderBook. One delta per level an operation touched, so a sweep
+//through ten levels gives ten deltas no matter how many orders it filled. Called on
+//the thread that drives the book, in the order the changes happened.
+class BookListener
+{
+public:
+	virtual ~BookListener() = default;
+
+	virtual void onLevel(const LevelDelta& delta) = 0;
+	virtual void onTrade(const TradeRecord& trade) { (void)trade; }
+};
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <limits>
+#include <functional>
+#include <type_traits>
+
+#include "datatypes.h"
+
+//Everything that differs between the bid and ask side, fixed at compile time. Level containers
+//take their ordering from here and the book writes per-side code once as a template over S.
+template<Side S>
+struct BookSide
+{
+	static constexpr Side opposite = (S == BUY) ? SELL : BUY;
+
+	using Compare = std::conditional_t<S == BUY, std::greater<Ticks>, std::less<Ticks>>; //Best price first
+	static constexpr int step = (S == BUY) ? -1 : 1; //One tick further from the best price
+
+	//A limit that takes every level on the other side
+	static constexpr Ticks marketPrice = (S == BUY) ? std::numeric_limits<Ticks>::max() : std::numeric_limits<Ticks>::lowest();
+
+	//price ranks level with or ahead of other on this side
+	static constexpr bool atOrBetter(Ticks price, Ticks other) { return !Compare{}(other, price); }
+
+	//An order on this side limited at limitPrice can trade with a level of the other side at levelPrice
+	static constexpr bool canTake(Ticks limitPrice, Ticks levelPrice) { return atOrBetter(limitPrice, levelPrice); }
+};
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "Checkpoint.h"
+#include "datatypes.h"
+
+static constexpr char CheckpointMagic[4] = { 'M', 'S', 'C', 'K' };
+static constexpr uint32_t CheckpointVersion = 4; //2 stores the stop kind, 3 whether a trade has printed, 4 fired stop counts
+static constexpr size_t CheckpointBufferSize = 1 << 20;
+
+CheckpointWriter::~CheckpointWriter()
+{
+	close();
+}
+
+bool CheckpointWriter::open(const std::string& path)
+{
+	close();
+
+	file = std::fopen(path.c_str(), "wb");
+	if (!file) return false;
+
+	std::setvbuf(file, nullptr, _IOFBF, CheckpointBufferSize);
+	failed = false;
+
+	CheckpointHeader header = {};
+	std::memcpy(header.magic, CheckpointMagic, sizeof(CheckpointMagic));
+	header.version = CheckpointVersion;
+	header.orderSize = sizeof(Order);
+	header.commandSize = sizeof(Command);
+	write(header);
+
+	return true;
+}
+
+bool CheckpointWriter::close()
+{
+	if (!file) return false;
+
+	if (std::fclose(file) != 0) failed = true;
+	file = nullptr;
+
+	return !failed;
+}
+
+bool CheckpointReader::open(const std::string& path)
+{
+	offset = 0;
+	failed = true;
+
+	if (!mapped.open(path)) return false;
+	failed = false;
+
+	CheckpointHeader header;
+	if (!read(header)) return false;
+
+	if (std::memcmp(header.magic, CheckpointMagic, sizeof(CheckpointMagic)) != 0 || header.version != CheckpointVersion
+		|| header.orderSize != sizeof(Order) || header.commandSize != sizeof(Command)) {
+		failed = true;
+		return false;
+	}
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+#include "MappedFile.h"
+
+struct CheckpointHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t orderSize; //Records are stored as they are in memory, so a build with
+	uint32_t commandSize; //different layouts refuses the file instead of misreading it
+};
+
+//Sequential binary writer for checkpoints. Values are trivially copyable and written as
+//they sit in memory, vectors with their length in front. Write errors are collected and
+//reported by close().
+class CheckpointWriter
+{
+private:
+	std::FILE* file = nullptr;
+	bool failed = false;
+public:
+	CheckpointWriter() = default;
+	~CheckpointWriter();
+
+	CheckpointWriter(const CheckpointWriter&) = delete;
+	CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+	bool open(const std::string& path);
+	bool close(); //True if every write made it to the file
+
+	void writeBytes(const void* data, size_t size)
+	{
+		if (file && size > 0 && std::fwrite(data, 1, size, file) != size) failed = true;
+	}
+
+	template<class T>
+	void write(const T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "checkpoint values are copied as bytes");
+		writeBytes(&value, sizeof(T));
+	}
+
+	template<class T>
+	void writeVector(const std::vector<T>& values)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "checkpoint values are copied as bytes");
+		write<uint64_t>(values.size());
+		writeBytes(values.data(), values.size() * sizeof(T));
+	}
+};
+
+//Reads a checkpoint straight out of a memory mapping. A read past the end fails and
+//leaves the reader failed, so a truncated file can't be taken for a good one.
+class CheckpointReader
+{
+private:
+	MappedFile mapped;
+	size_t offset = 0;
+	bool failed = false;
+public:
+	bool open(const std::string& path); //Maps the file and checks its header
+
+	bool ok() const { return !failed; }
+	bool atEnd() const { return offset == mapped.getSize(); }
+
+	bool readBytes(void* out, size_t size)
+	{
+		if (failed || size > mapped.getSize() - offset) {
+			failed = true;
+			return false;
+		}
+		if (size > 0) std::memcpy(out, mapped.getData() + offset, size);
+		offset += size;
+		return true;
+	}
+
+	template<class T>
+	bool read(T& value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "checkpoint values are copied as bytes");
+		return readBytes(&value, sizeof(T));
+	}
+
+	//Reads a length and checks it fits in what is left of the file before allocating
+	bool readCount(size_t& count, size_t elementSize)
+	{
+		uint64_t length;
+		if (!read(length)) return false;
+		if (elementSize > 0 && length > (mapped.getSize() - offset) / elementSize) {
+			failed = true;
+			return false;
+		}
+		count = static_cast<size_t>(length);
+		return true;
+	}
+
+	template<class T>
+	bool readVector(std::vector<T>& values)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "checkpoint values are copied as bytes");
+		size_t count;
+		if (!readCount(count, sizeof(T))) return false;
+		values.resize(count);
+		return readBytes(values.data(), count * sizeof(T));
+	}
+};
\ No newline at end of file
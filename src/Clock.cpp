@@ -10,4 +10,9 @@ Time Clock::now() const
 void Clock::advance(Time dt)
 {
 	curTime += dt;
+}
+
+void Clock::advanceTo(Time time)
+{
+	if (time > curTime) curTime = time;
 }
\ No newline at end of file
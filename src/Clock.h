@@ -10,4 +10,5 @@ public:
 	Time now() const;
 
 	void advance(Time dt);
+	void advanceTo(Time time); //Never moves back
 };
\ No newline at end of file
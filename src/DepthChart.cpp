@@ -4,22 +4,28 @@
 #include <SFML/Graphics/RenderStates.hpp>
 #include <SFML/System/Vector2.hpp>
 #include <vector>
+#include <algorithm>
 
 #include "datatypes.h"
-#include "LimitOrderBook.h"
 #include "DepthChart.h"
 #include "UIHelpers.h"
+#include "Profiler.h"
 
 DepthChart::DepthChart() {
     bidTriangles.setPrimitiveType(sf::PrimitiveType::TriangleStrip);
     askTriangles.setPrimitiveType(sf::PrimitiveType::TriangleStrip);
 }
 
-void DepthChart::update(const LimitOrderBook& LOB, float chartWidth, float chartHeight, sf::Vector2u winSize) {
-    long totalVolume = 0;
-    std::vector<DepthPoint> depthPoints = LOB.depthChartPoints(0.5f, &totalVolume);
+void DepthChart::update(const BookSnapshot& snapshot, float chartWidth, float chartHeight, sf::Vector2u winSize) {
+    if (snapshot.sequence == drawnSequence) return;
+    drawnSequence = snapshot.sequence;
 
-    if (depthPoints.empty()) {
+    MARKETSIM_PROFILE_SCOPE(Probe::DepthChartUpdate);
+
+    const std::vector<LevelInfo>& bidLevels = snapshot.bids;
+    const std::vector<LevelInfo>& askLevels = snapshot.asks;
+
+    if (bidLevels.empty() || askLevels.empty()) {
         bidTriangles.clear();
         askTriangles.clear();
         return;
@@ -27,54 +33,58 @@ void DepthChart::update(const LimitOrderBook& LOB, float chartWidth, float chart
 
     int offset = -100;
 
-    float binWidth = chartWidth / static_cast<float>(depthPoints.size() - 1);
+    //Points run from the deepest bid through a zero-volume midpoint to the deepest ask
+    size_t bidCount = bidLevels.size();
+    size_t askCount = askLevels.size();
+    size_t pointCount = bidCount + 1 + askCount;
+
+    long bidTotal = 0;
+    for (const LevelInfo& level : bidLevels) bidTotal += level.volume;
+    long askTotal = 0;
+    for (const LevelInfo& level : askLevels) askTotal += level.volume;
+    long totalVolume = std::max(bidTotal, askTotal);
+
+    float binWidth = chartWidth / static_cast<float>(pointCount - 1);
     float bottomOfChart = (float)winSize.y;
     float startX = winSize.x - chartWidth + offset;
 
-    size_t splitIndex = 0;
-    for (size_t i = 0; i < depthPoints.size(); i++) {
-        if (depthPoints[i].totalVolume == 0) {
-            splitIndex = i;
-            break;
-        }
-    }
-
-    bidTriangles.resize((splitIndex + 1) * 2);
-    size_t askCount = depthPoints.size() - splitIndex;
-    askTriangles.resize(askCount * 2);
+    bidTriangles.resize((bidCount + 1) * 2);
+    askTriangles.resize((askCount + 1) * 2);
 
-    for (size_t i = 0; i <= splitIndex; i++)
+    long runningBidVol = bidTotal;
+    for (size_t i = 0; i <= bidCount; i++)
     {
-        auto& curPoint = depthPoints[i];
-
-        float hPerc = (totalVolume > 0) ? (float)curPoint.totalVolume / totalVolume : 0.f;
+        float hPerc = (totalVolume > 0) ? (float)runningBidVol / totalVolume : 0.f;
         float xPos = startX + (i * binWidth);
         float yPeak = bottomOfChart - (hPerc * chartHeight);
 
         bidTriangles[2 * i].position = { xPos, yPeak };
         bidTriangles[2 * i + 1].position = { xPos, bottomOfChart };
 
-        sf::Color topCol = (curPoint.totalVolume == 0) ? Theme::TextDim : Theme::Bid;
-        sf::Color botCol = (curPoint.totalVolume == 0) ? Theme::TextDim : Theme::BidBG;
+        sf::Color topCol = (runningBidVol == 0) ? Theme::TextDim : Theme::Bid;
+        sf::Color botCol = (runningBidVol == 0) ? Theme::TextDim : Theme::BidBG;
 
         bidTriangles[2 * i].color = topCol;
         bidTriangles[2 * i + 1].color = botCol;
+
+        if (i < bidCount) runningBidVol -= bidLevels[bidCount - 1 - i].volume;
     }
 
-    for (size_t i = 0; i < askCount; i++)
+    long runningAskVol = 0;
+    for (size_t i = 0; i <= askCount; i++)
     {
-        size_t dataIdx = splitIndex + i; //Offset to other side
-        auto& curPoint = depthPoints[dataIdx];
+        size_t dataIdx = bidCount + i; //Offset to other side
+        if (i > 0) runningAskVol += askLevels[i - 1].volume;
 
-        float hPerc = (totalVolume > 0) ? (float)curPoint.totalVolume / totalVolume : 0.f;
+        float hPerc = (totalVolume > 0) ? (float)runningAskVol / totalVolume : 0.f;
         float xPos = startX + (dataIdx * binWidth);
         float yPeak = bottomOfChart - (hPerc * chartHeight);
 
         askTriangles[2 * i].position = { xPos, yPeak };
         askTriangles[2 * i + 1].position = { xPos, bottomOfChart };
 
-        sf::Color topCol = (curPoint.totalVolume == 0) ? Theme::TextDim : Theme::Ask;
-        sf::Color botCol = (curPoint.totalVolume == 0) ? Theme::TextDim : Theme::AskBG;
+        sf::Color topCol = (runningAskVol == 0) ? Theme::TextDim : Theme::Ask;
+        sf::Color botCol = (runningAskVol == 0) ? Theme::TextDim : Theme::AskBG;
 
         askTriangles[2 * i].color = topCol;
         askTriangles[2 * i + 1].color = botCol;
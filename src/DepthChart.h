@@ -1,21 +1,27 @@
 #pragma once
 
+#include <vector>
+
 #include <SFML/Graphics/Drawable.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/RenderStates.hpp>
 #include <SFML/Graphics/VertexArray.hpp>
 #include <SFML/System/Vector2.hpp>
 
-class LimitOrderBook;
+#include "SimulationThread.h"
 
+//Draws the levels of the latest book snapshot and only rebuilds the curve when a new
+//snapshot arrived, reusing its buffers
 class DepthChart : public sf::Drawable {
 private:
     virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
 
     sf::VertexArray bidTriangles;
     sf::VertexArray askTriangles;
+
+    uint64_t drawnSequence = 0;
 public:
     DepthChart();
 
-    void update(const LimitOrderBook& LOB, float chartWidth, float chartHeight, sf::Vector2u winSize);
+    void update(const BookSnapshot& snapshot, float chartWidth, float chartHeight, sf::Vector2u winSize);
 };
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cmath>
+
+#include "Ensemble.h"
+
+void RunningStats::add(double value)
+{
+	count++;
+	if (count == 1) {
+		min = value;
+		max = value;
+	}
+	else {
+		min = std::min(min, value);
+		max = std::max(max, value);
+	}
+
+	double delta = value - mean;
+	mean += delta / count;
+	m2 += delta * (value - mean);
+}
+
+size_t RunningStats::getCount() const
+{
+	return count;
+}
+
+double RunningStats::getMean() const
+{
+	return mean;
+}
+
+double RunningStats::getStdDev() const
+{
+	return count > 1 ? std::sqrt(m2 / (count - 1)) : 0.0;
+}
+
+double RunningStats::getMin() const
+{
+	return min;
+}
+
+double RunningStats::getMax() const
+{
+	return max;
+}
+
+static void addSummary(EnsembleStats& stats, const RunSummary& summary)
+{
+	stats.runs++;
+	stats.finalMid.add(summary.finalMid);
+	stats.maxDrawdown.add(summary.maxDrawdown);
+	stats.tradedVolume.add(summary.tradedVolume);
+}
+
+Ensemble::Ensemble(const EnsembleConfig& config)
+	: config(config),
+	pool(config.threads)
+{
+	this->config.scenario.parallelDecide = false; //The pool is already busy with whole runs
+	this->config.scenario.tradeRetention = 0;
+	this->config.scenario.midPriceRetention = 0;
+}
+
+RunSummary Ensemble::runOne(size_t index) const
+{
+	SimulationConfig scenario = config.scenario;
+	scenario.seed = config.scenario.seed + index;
+
+	Simulation sim(scenario);
+	const LimitOrderBook& LOB = sim.getBook();
+
+	RunSummary summary;
+	double peak = 0.0;
+
+	for (long long i = 0; i < config.ticks; i++)
+	{
+		sim.step();
+
+		double mid = LOB.getMidPriceHistory().back();
+		peak = std::max(peak, mid);
+		if (peak > 0.0) summary.maxDrawdown = std::max(summary.maxDrawdown, (peak - mid) / peak);
+	}
+
+	if (!LOB.getMidPriceHistory().empty()) summary.finalMid = LOB.getMidPriceHistory().back();
+	summary.tradedVolume = static_cast<double>(LOB.getTradedVolume());
+	summary.trades = LOB.getTradeCount();
+
+	return summary;
+}
+
+void Ensemble::run(const std::function<void(const EnsembleStats&)>& onProgress)
+{
+	summaries.assign(config.runs, RunSummary{});
+	liveStats = {};
+
+	pool.parallelFor(config.runs, [&](size_t i) {
+		summaries[i] = runOne(i);
+
+		std::lock_guard<std::mutex> lock(statsMutex);
+		addSummary(liveStats, summaries[i]);
+		if (onProgress && config.reportEvery > 0 && liveStats.runs % config.reportEvery == 0) onProgress(liveStats);
+	});
+
+	stats = {};
+	for (const RunSummary& summary : summaries) addSummary(stats, summary);
+}
+
+const EnsembleStats& Ensemble::getStats() const
+{
+	return stats;
+}
+
+const std::vector<RunSummary>& Ensemble::getSummaries() const
+{
+	return summaries;
+}
+
+double Ensemble::percentile(double RunSummary::* field, double p) const
+{
+	if (summaries.empty()) return 0.0;
+
+	std::vector<double> values;
+	values.reserve(summaries.size());
+	for (const RunSummary& summary : summaries) values.push_back(summary.*field);
+
+	size_t rank = static_cast<size_t>(std::clamp(p, 0.0, 1.0) * (values.size() - 1) + 0.5);
+	std::nth_element(values.begin(), values.begin() + rank, values.end());
+	return values[rank];
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+
+#include "Simulation.h"
+#include "ThreadPool.h"
+
+struct EnsembleConfig
+{
+	SimulationConfig scenario; //Run i uses scenario.seed + i, always with sequential decide
+	size_t runs = 1000;
+	long long ticks = 1000; //Steps per run
+	size_t threads = 0; //0 uses every hardware thread
+	size_t reportEvery = 0; //Progress callback every N finished runs, 0 for none
+};
+
+//What is left of a run once its Simulation is gone
+struct RunSummary
+{
+	double finalMid = 0.0;
+	double maxDrawdown = 0.0; //Largest fall from a running peak of the mid, as a fraction of that peak
+	double tradedVolume = 0.0;
+	size_t trades = 0;
+};
+
+//Count, mean, variance (Welford), min and max without keeping the samples
+class RunningStats
+{
+private:
+	size_t count = 0;
+	double mean = 0.0;
+	double m2 = 0.0;
+	double min = 0.0;
+	double max = 0.0;
+public:
+	void add(double value);
+
+	size_t getCount() const;
+	double getMean() const;
+	double getStdDev() const;
+	double getMin() const;
+	double getMax() const;
+};
+
+struct EnsembleStats
+{
+	size_t runs = 0;
+	RunningStats finalMid;
+	RunningStats maxDrawdown;
+	RunningStats tradedVolume;
+};
+
+//Runs many independent copies of the scenario (book, traders, strategies, clock each)
+//across a ThreadPool. Runs are handed out dynamically, so a slow run never holds up
+//a whole block of others. Books keep no history beyond their newest chunk, so a run
+//only leaves its RunSummary behind.
+class Ensemble
+{
+private:
+	EnsembleConfig config;
+	ThreadPool pool;
+
+	std::mutex statsMutex;
+	EnsembleStats liveStats; //In completion order, only for progress reports
+	EnsembleStats stats;
+	std::vector<RunSummary> summaries;
+
+	RunSummary runOne(size_t index) const;
+public:
+	explicit Ensemble(const EnsembleConfig& config);
+
+	Ensemble(const Ensemble&) = delete;
+	Ensemble& operator=(const Ensemble&) = delete;
+
+	//onProgress is called under a lock from whichever thread finished the run.
+	//The final stats are rebuilt in run order, so they repeat exactly for a given seed.
+	void run(const std::function<void(const EnsembleStats&)>& onProgress = nullptr);
+
+	const EnsembleStats& getStats() const;
+	const std::vector<RunSummary>& getSummaries() const;
+
+	//p in [0, 1] over the finished runs, e.g. percentile(&RunSummary::finalMid, 0.05)
+	double percentile(double RunSummary::* field, double p) const;
+};
\ No newline at end of file
@@ -0,0 +1,240 @@
+#include "Exchange.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+static void pinToCore(std::thread& thread, size_t core)
+{
+	unsigned cores = std::thread::hardware_concurrency();
+	if (cores == 0) return;
+	core %= cores;
+
+#if defined(_WIN32)
+	SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << core);
+#elif defined(__linux__)
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(core, &set);
+	pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+	(void)thread; //No portable affinity API, leave it to the scheduler
+#endif
+}
+
+Exchange::Shard::Shard(SymbolId symbol, size_t queueCapacity)
+	: book(symbol),
+	inbox(queueCapacity),
+	outbox(queueCapacity)
+{
+	book.addListener(this);
+}
+
+Exchange::Exchange(size_t symbols, size_t queueCapacity, bool pinThreads)
+{
+	shards.reserve(symbols);
+	for (size_t i = 0; i < symbols; i++) {
+		shards.push_back(std::make_unique<Shard>(static_cast<SymbolId>(i), queueCapacity));
+	}
+
+	for (size_t i = 0; i < symbols; i++) {
+		Shard& shard = *shards[i];
+		shard.worker = std::thread(&Exchange::workerLoop, this, std::ref(shard));
+		if (pinThreads) pinToCore(shard.worker, i);
+	}
+}
+
+Exchange::~Exchange()
+{
+	stopping.store(true, std::memory_order_seq_cst);
+	for (auto& shard : shards) {
+		{
+			std::lock_guard<std::mutex> lock(shard->wakeMutex);
+		}
+		shard->wake.notify_one();
+		shard->worker.join();
+	}
+}
+
+void Exchange::setTraderRegistry(TraderRegistry* registry)
+{
+	this->registry = registry;
+}
+
+void Exchange::setHistoryRetention(size_t trades, size_t midPrices)
+{
+	for (auto& shard : shards) shard->book.setHistoryRetention(trades, midPrices);
+}
+
+static constexpr unsigned IdleSpins = 64;
+static constexpr unsigned IdleYields = 1024;
+
+void Exchange::workerLoop(Shard& shard)
+{
+	ExchangeMessage message;
+	unsigned idleSpins = 0;
+
+	while (!stopping.load(std::memory_order_acquire))
+	{
+		if (!shard.inbox.tryPop(message)) {
+			//Spin, then give the core away, then sleep
+			if (++idleSpins > IdleYields) {
+				sleep(shard);
+				idleSpins = 0;
+			}
+			else if (idleSpins > IdleSpins) {
+				std::this_thread::yield();
+			}
+			continue;
+		}
+
+		idleSpins = 0;
+		handle(shard, message);
+		shard.processed.fetch_add(1, std::memory_order_release);
+	}
+}
+
+void Exchange::sleep(Shard& shard)
+{
+	std::unique_lock<std::mutex> lock(shard.wakeMutex);
+	shard.sleeping.store(true, std::memory_order_relaxed);
+
+	//Pairs with the fence in post(): either the poster sees sleeping and notifies, or the
+	//message it pushed is seen here and the worker doesn't wait
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	shard.wake.wait(lock, [&] { return !shard.inbox.empty() || stopping.load(std::memory_order_acquire); });
+
+	shard.sleeping.store(false, std::memory_order_relaxed);
+}
+
+void Exchange::post(Shard& shard, const ExchangeMessage& message)
+{
+	while (!shard.inbox.tryPush(message)) {
+		//Keep the worker's outbox moving so it can't stall on us while we wait
+		collectReports(shard);
+		std::this_thread::yield();
+	}
+	shard.submitted++;
+
+	//Only the first post after the worker went to sleep pays for the wake-up
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (shard.sleeping.load(std::memory_order_relaxed) && shard.sleeping.exchange(false, std::memory_order_relaxed)) {
+		//Taking the lock waits out a worker that is between setting sleeping and waiting
+		{
+			std::lock_guard<std::mutex> lock(shard.wakeMutex);
+		}
+		shard.wake.notify_one();
+	}
+}
+
+void Exchange::handle(Shard& shard, const ExchangeMessage& message)
+{
+	if (message.time > shard.clock.now()) shard.clock.advance(message.time - shard.clock.now());
+
+	if (message.type == ExchangeMessageType::SampleMid) {
+		shard.book.update(shard.clock);
+		return;
+	}
+
+	const Command& command = message.command;
+	OrderId id = 0;
+
+	switch (command.type)
+	{
+	case CommandType::NewOrder:
+		id = shard.book.processOrder(command.order, shard.clock);
+		break;
+	case CommandType::Cancel:
+		shard.book.cancelOrder(command.targetId);
+		break;
+	case CommandType::Amend:
+		shard.book.amendOrder(command.targetId, command.order.price, command.order.volume, shard.clock);
+		break;
+	case CommandType::Quote:
+		shard.book.massQuote(command.order.traderId, command.order, command.quoteAsk, shard.clock);
+		break;
+	case CommandType::Stop:
+		id = shard.book.placeStop(command.order, command.triggerPrice, command.stopKind, shard.clock);
+		break;
+	}
+
+	auto push = [&](const ExecutionReport& report) {
+		while (!shard.outbox.tryPush(report)) std::this_thread::yield();
+	};
+
+	if ((command.type == CommandType::NewOrder || command.type == CommandType::Stop) && command.trackActive) {
+		ExecutionReport accepted = {};
+		accepted.type = ExecutionReportType::Accepted;
+		accepted.traderId = command.order.traderId;
+		accepted.orderId = id;
+		push(accepted);
+	}
+
+	for (const TradeRecord& trade : shard.fills) {
+		ExecutionReport fill = {};
+		fill.type = ExecutionReportType::Trade;
+		fill.trade = trade;
+		push(fill);
+	}
+	shard.fills.clear();
+}
+
+void Exchange::collectReports(Shard& shard)
+{
+	ExecutionReport report;
+	while (shard.outbox.tryPop(report)) shard.pending.push_back(report);
+}
+
+void Exchange::submit(SymbolId symbol, const Command& command, TimeStamp time)
+{
+	post(*shards[symbol], { ExchangeMessageType::Command, time, command });
+}
+
+void Exchange::sampleMidPrices(TimeStamp time)
+{
+	for (auto& shard : shards) post(*shard, { ExchangeMessageType::SampleMid, time, {} });
+}
+
+void Exchange::settle(SymbolId symbol, const ExecutionReport& report)
+{
+	if (!registry) return;
+
+	if (report.type == ExecutionReportType::Accepted) {
+		if (registry->contains(report.traderId)) registry->addActiveOrderId(report.traderId, report.orderId, symbol);
+		return;
+	}
+
+	registry->settle(report.trade, symbol);
+}
+
+void Exchange::sync()
+{
+	for (auto& shard : shards) {
+		while (shard->processed.load(std::memory_order_acquire) != shard->submitted) {
+			collectReports(*shard);
+			std::this_thread::yield();
+		}
+		collectReports(*shard);
+	}
+
+	//Shard order keeps settlement deterministic no matter how the workers interleaved
+	for (size_t i = 0; i < shards.size(); i++) {
+		for (const ExecutionReport& report : shards[i]->pending) settle(static_cast<SymbolId>(i), report);
+		shards[i]->pending.clear();
+	}
+}
+
+size_t Exchange::getSymbolCount() const
+{
+	return shards.size();
+}
+
+const LimitOrderBook& Exchange::getBook(SymbolId symbol) const
+{
+	return shards[symbol]->book;
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#include "datatypes.h"
+#include "Clock.h"
+#include "LimitOrderBook.h"
+#include "SpscQueue.h"
+#include "TraderRegistry.h"
+#include "BookListener.h"
+
+enum class ExchangeMessageType : uint8_t
+{
+	Command,
+	SampleMid
+};
+
+struct ExchangeMessage
+{
+	ExchangeMessageType type;
+	TimeStamp time;
+	Command command;
+};
+
+enum class ExecutionReportType : uint8_t
+{
+	Accepted,
+	Trade
+};
+
+struct ExecutionReport
+{
+	ExecutionReportType type;
+	TraderId traderId; //Accepted only
+	OrderId orderId; //Accepted only
+	TradeRecord trade; //Trade only
+};
+
+//One book per symbol, each owned by its own worker thread (pinned to a core where
+//the platform allows). Commands reach a book through its inbox queue; accepted order
+//ids and trades come back through its outbox and are settled on the calling thread in
+//sync(). Only one thread may submit and sync. A worker with nothing to do spins briefly,
+//then sleeps until the next message.
+class Exchange
+{
+private:
+	//Listens to its own book for the fills of the message being handled
+	struct Shard : BookListener
+	{
+		LimitOrderBook book;
+		Clock clock;
+
+		SpscQueue<ExchangeMessage> inbox;
+		SpscQueue<ExecutionReport> outbox;
+
+		size_t submitted = 0; //Caller side
+		std::atomic<size_t> processed{ 0 }; //Worker side
+		std::vector<TradeRecord> fills; //Worker side, reported once the message is done
+
+		std::mutex wakeMutex;
+		std::condition_variable wake;
+		std::atomic<bool> sleeping{ false }; //Set while the worker waits on wake, so posts only notify then
+
+		std::vector<ExecutionReport> pending; //Reports collected but not yet settled
+		std::thread worker;
+
+		Shard(SymbolId symbol, size_t queueCapacity);
+
+		void onLevel(const LevelDelta& delta) override { (void)delta; }
+		void onTrade(const TradeRecord& trade) override { fills.push_back(trade); }
+	};
+
+	std::vector<std::unique_ptr<Shard>> shards;
+	TraderRegistry* registry = nullptr;
+	std::atomic<bool> stopping{ false };
+
+	void workerLoop(Shard& shard);
+	void sleep(Shard& shard); //Until a message arrives or the exchange stops
+	void handle(Shard& shard, const ExchangeMessage& message);
+	void post(Shard& shard, const ExchangeMessage& message);
+	void collectReports(Shard& shard);
+	void settle(SymbolId symbol, const ExecutionReport& report);
+public:
+	explicit Exchange(size_t symbols, size_t queueCapacity = 1 << 16, bool pinThreads = true);
+	~Exchange();
+
+	Exchange(const Exchange&) = delete;
+	Exchange& operator=(const Exchange&) = delete;
+
+	void setTraderRegistry(TraderRegistry* registry);
+	void setHistoryRetention(size_t trades, size_t midPrices); //Every book, before the first submit
+
+	void submit(SymbolId symbol, const Command& command, TimeStamp time);
+	void sampleMidPrices(TimeStamp time); //LimitOrderBook::update on every book
+
+	//Waits for every book to work through its inbox, then settles fills and hands accepted
+	//ids to traders, shard by shard. Books may only be read between sync() and the next submit.
+	void sync();
+
+	size_t getSymbolCount() const;
+	const LimitOrderBook& getBook(SymbolId symbol) const;
+};
\ No newline at end of file
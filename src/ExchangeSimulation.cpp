@@ -0,0 +1,76 @@
+#include "ExchangeSimulation.h"
+
+ExchangeSimulation::ExchangeSimulation(const SimulationConfig& config, size_t symbols)
+	: config(config),
+	exchange(symbols),
+	whale(&randomStrat, registry, static_cast<TraderId>(symbols * (config.trendTraders + config.randomTraders)), 100000.0, 20000L)
+{
+	size_t perSymbol = config.randomTraders + config.trendTraders;
+	traders.reserve(symbols * perSymbol);
+
+	for (size_t symbol = 0; symbol < symbols; symbol++) {
+		TraderId firstId = static_cast<TraderId>(symbol * perSymbol);
+
+		for (size_t i = 0; i < config.randomTraders; i++) {
+			traders.emplace_back(&randomStrat, registry, firstId + static_cast<TraderId>(i), 2000.0, 0L);
+		}
+		for (size_t i = 0; i < config.trendTraders; i++) {
+			traders.emplace_back(&trendStrat, registry, firstId + static_cast<TraderId>(config.randomTraders + i), 2000.0, 0L);
+		}
+
+		for (size_t i = 0; i < perSymbol; i++) {
+			traders[traders.size() - perSymbol + i].changeStocks(100L, static_cast<SymbolId>(symbol));
+			traderSymbols.push_back(static_cast<SymbolId>(symbol));
+		}
+	}
+
+	for (auto& t : traders) t.seedRng(config.seed);
+	exchange.setTraderRegistry(&registry);
+	exchange.setHistoryRetention(config.tradeRetention, config.midPriceRetention);
+
+	commandBuffers.resize(traders.size());
+
+	if (config.parallelDecide) pool = std::make_unique<ThreadPool>(config.threads);
+}
+
+void ExchangeSimulation::step()
+{
+	clock.advance(config.dt);
+	TimeStamp now = static_cast<TimeStamp>(clock.now());
+
+	exchange.sampleMidPrices(now);
+
+	if (clock.now() == 30) {
+		Order whalePanic = makeOrder(whale.getId(), Side::SELL, 10.0, 2000, clock.now());
+		exchange.submit(0, makeOrderCommand(whalePanic, false), now);
+	}
+
+	exchange.sync();
+
+	auto decide = [this](size_t i) {
+		commandBuffers[i].clear();
+		traders[i].update(exchange.getBook(traderSymbols[i]), clock, commandBuffers[i]);
+	};
+
+	if (pool) pool->parallelFor(traders.size(), decide);
+	else for (size_t i = 0; i < traders.size(); i++) decide(i);
+
+	for (size_t i = 0; i < traders.size(); i++) {
+		for (const Command& command : commandBuffers[i]) exchange.submit(traderSymbols[i], command, now);
+	}
+}
+
+void ExchangeSimulation::sync()
+{
+	exchange.sync();
+}
+
+const Exchange& ExchangeSimulation::getExchange() const
+{
+	return exchange;
+}
+
+size_t ExchangeSimulation::getTraderCount() const
+{
+	return traders.size() + 1;
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+
+#include "Clock.h"
+#include "Exchange.h"
+#include "Simulation.h"
+#include "Trader.h"
+#include "TraderRegistry.h"
+#include "TrendStrategy.h"
+#include "RandomStrategy.h"
+#include "ThreadPool.h"
+
+//The Simulation scenario repeated on every symbol of an Exchange. Each symbol gets its
+//own group of traders (config's counts) and symbol 0 gets the whale.
+//
+//Each step: advance the clock, sample every mid price, run scripted events, sync the
+//exchange, let every trader decide against the synced book of its symbol, then submit the
+//commands (symbols in order, random then trend traders by id within a symbol). Traders
+//never see orders sent in the same tick, the books match them on their workers during
+//the next sync.
+class ExchangeSimulation
+{
+private:
+	SimulationConfig config;
+
+	Clock clock;
+	Exchange exchange;
+	TraderRegistry registry;
+
+	TrendStrategy trendStrat;
+	RandomStrategy randomStrat;
+
+	std::vector<Trader> traders;
+	std::vector<SymbolId> traderSymbols;
+	Trader whale;
+
+	std::vector<std::vector<Command>> commandBuffers;
+	std::unique_ptr<ThreadPool> pool;
+public:
+	ExchangeSimulation(const SimulationConfig& config, size_t symbols);
+
+	ExchangeSimulation(const ExchangeSimulation&) = delete;
+	ExchangeSimulation& operator=(const ExchangeSimulation&) = delete;
+
+	void step();
+	void sync();
+
+	const Exchange& getExchange() const;
+	size_t getTraderCount() const;
+};
\ No newline at end of file
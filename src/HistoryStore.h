@@ -0,0 +1,221 @@
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "datatypes.h"
+#include "Checkpoint.h"
+
+constexpr size_t HistoryUnlimited = SIZE_MAX;
+
+//Append-only history in fixed-size columnar chunks. Rows get a global index in push
+//order that never changes, chunks never move and growing never copies old rows.
+//With a retention limit the oldest whole chunks are dropped (and recycled) once at
+//least that many newer rows exist, so memory stays flat on long runs.
+//Timestamps must not decrease, which lets range queries binary search them.
+//
+//Chunk supplies the columns: Row, Capacity, a time column and get/set.
+template<class Chunk>
+class ChunkedHistory
+{
+public:
+	using Row = typename Chunk::Row;
+	static constexpr size_t ChunkRows = Chunk::Capacity;
+
+	class const_iterator
+	{
+	private:
+		const ChunkedHistory* history;
+		size_t index;
+	public:
+		const_iterator(const ChunkedHistory* history, size_t index) : history(history), index(index) {}
+
+		Row operator*() const { return (*history)[index]; }
+		const_iterator& operator++() { ++index; return *this; }
+		bool operator==(const const_iterator& other) const { return index == other.index; }
+		bool operator!=(const const_iterator& other) const { return index != other.index; }
+
+		size_t getIndex() const { return index; }
+	};
+
+	//A fixed index range. It stays usable while the history grows, rows that
+	//retention has dropped since are skipped.
+	class View
+	{
+	private:
+		const ChunkedHistory* history;
+		size_t first;
+		size_t last;
+	public:
+		View(const ChunkedHistory* history, size_t first, size_t last) : history(history), first(first), last(last) {}
+
+		const_iterator begin() const { return const_iterator(history, std::min(last, std::max(first, history->getFirstIndex()))); }
+		const_iterator end() const { return const_iterator(history, last); }
+		size_t size() const { return last - begin().getIndex(); }
+		bool empty() const { return size() == 0; }
+	};
+private:
+	std::deque<std::unique_ptr<Chunk>> chunks;
+	std::unique_ptr<Chunk> spare; //Last dropped chunk, reused so steady state doesn't allocate
+
+	size_t firstIndex = 0; //Global index of the first row in chunks.front()
+	size_t count = 0; //Rows ever pushed
+	size_t retention = HistoryUnlimited;
+
+	const Chunk& chunkOf(size_t index) const { return *chunks[(index - firstIndex) / ChunkRows]; }
+
+	void dropExpired()
+	{
+		while (!chunks.empty())
+		{
+			bool frontFull = chunks.size() > 1 || count - firstIndex == ChunkRows;
+			if (!frontFull || count - firstIndex - ChunkRows < retention) break;
+
+			spare = std::move(chunks.front());
+			chunks.pop_front();
+			firstIndex += ChunkRows;
+		}
+	}
+public:
+	void push(TimeStamp time, const Row& row)
+	{
+		size_t slot = count % ChunkRows;
+
+		if (slot == 0) {
+			dropExpired();
+			if (chunks.empty()) firstIndex = count;
+			chunks.push_back(spare ? std::move(spare) : std::make_unique<Chunk>());
+		}
+
+		Chunk& chunk = *chunks.back();
+		chunk.time[slot] = time;
+		chunk.set(slot, row);
+		count++;
+	}
+
+	void setRetention(size_t rows)
+	{
+		retention = rows;
+		dropExpired();
+	}
+
+	size_t getRetention() const { return retention; }
+
+	size_t size() const { return count; } //Rows ever pushed, one past the newest index
+	size_t getFirstIndex() const { return firstIndex; } //Oldest retained row
+	size_t retained() const { return count - firstIndex; }
+	bool empty() const { return retained() == 0; }
+	bool contains(size_t index) const { return index >= firstIndex && index < count; }
+
+	//index must be retained
+	Row operator[](size_t index) const { return chunkOf(index).get((index - firstIndex) % ChunkRows); }
+	TimeStamp timeAt(size_t index) const { return chunkOf(index).time[(index - firstIndex) % ChunkRows]; }
+	Row back() const { return (*this)[count - 1]; }
+
+	const_iterator begin() const { return const_iterator(this, firstIndex); }
+	const_iterator end() const { return const_iterator(this, count); }
+
+	//First retained index with a timestamp >= time, size() if there is none
+	size_t lowerBound(TimeStamp time) const
+	{
+		size_t lo = firstIndex;
+		size_t hi = count;
+		while (lo < hi)
+		{
+			size_t mid = lo + (hi - lo) / 2;
+			if (timeAt(mid) < time) lo = mid + 1;
+			else hi = mid;
+		}
+		return lo;
+	}
+
+	View view(size_t first, size_t last) const { return View(this, first, std::min(last, count)); }
+	View range(TimeStamp from, TimeStamp to) const { return View(this, lowerBound(from), lowerBound(to)); } //[from, to)
+
+	size_t memoryBytes() const { return (chunks.size() + (spare ? 1 : 0)) * sizeof(Chunk); }
+
+	//The retained rows and where their numbering starts. Loading keeps this history's own
+	//retention and drops whatever it wouldn't have kept.
+	void saveState(CheckpointWriter& writer) const
+	{
+		writer.write<uint64_t>(firstIndex);
+		writer.write<uint64_t>(count);
+		for (size_t i = firstIndex; i < count; i++) {
+			writer.write(timeAt(i));
+			writer.write((*this)[i]);
+		}
+	}
+
+	bool loadState(CheckpointReader& reader)
+	{
+		uint64_t first;
+		uint64_t total;
+		if (!reader.read(first) || !reader.read(total) || first > total || first % ChunkRows != 0) return false;
+
+		while (!chunks.empty()) {
+			spare = std::move(chunks.back());
+			chunks.pop_back();
+		}
+		firstIndex = count = static_cast<size_t>(first);
+
+		for (uint64_t i = first; i < total; i++) {
+			TimeStamp time;
+			Row row;
+			if (!reader.read(time) || !reader.read(row)) return false;
+			push(time, row);
+		}
+		return true;
+	}
+};
+
+struct TradeChunk
+{
+	using Row = TradeRecord;
+	static constexpr size_t Capacity = 4096;
+
+	TimeStamp time[Capacity];
+	uint32_t tradeId[Capacity];
+	Ticks price[Capacity];
+	Volume volume[Capacity];
+	TraderId buyerId[Capacity];
+	TraderId sellerId[Capacity];
+
+	void set(size_t i, const TradeRecord& trade)
+	{
+		tradeId[i] = trade.tradeId;
+		price[i] = trade.price;
+		volume[i] = trade.volume;
+		buyerId[i] = trade.buyerId;
+		sellerId[i] = trade.sellerId;
+	}
+
+	TradeRecord get(size_t i) const
+	{
+		TradeRecord trade = {};
+		trade.tradeId = tradeId[i];
+		trade.price = price[i];
+		trade.volume = volume[i];
+		trade.buyerId = buyerId[i];
+		trade.sellerId = sellerId[i];
+		trade.timeStamp = time[i];
+		return trade;
+	}
+};
+
+struct MidPriceChunk
+{
+	using Row = double;
+	static constexpr size_t Capacity = 4096;
+
+	TimeStamp time[Capacity];
+	double price[Capacity];
+
+	void set(size_t i, double mid) { price[i] = mid; }
+	double get(size_t i) const { return price[i]; }
+};
+
+using TradeHistory = ChunkedHistory<TradeChunk>;
+using MidPriceHistory = ChunkedHistory<MidPriceChunk>;
\ No newline at end of file
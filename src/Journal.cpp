@@ -0,0 +1,232 @@
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+#include "Journal.h"
+#include "MappedFile.h"
+#include "LimitOrderBook.h"
+#include "Clock.h"
+
+static constexpr char JournalMagic[4] = { 'M', 'S', 'J', 'L' };
+static constexpr uint32_t JournalVersion = 4; //2 added Amend records, 3 Stop records, 4 the stop kind
+static constexpr size_t JournalBufferSize = 1 << 20;
+
+JournalWriter::~JournalWriter()
+{
+	close();
+}
+
+bool JournalWriter::open(const std::string& path)
+{
+	close();
+
+	file = std::fopen(path.c_str(), "wb");
+	if (!file) return false;
+
+	std::setvbuf(file, nullptr, _IOFBF, JournalBufferSize);
+
+	JournalHeader header = {};
+	std::memcpy(header.magic, JournalMagic, sizeof(header.magic));
+	header.version = JournalVersion;
+	header.recordSize = sizeof(JournalRecord);
+	std::fwrite(&header, sizeof(header), 1, file);
+
+	return true;
+}
+
+void JournalWriter::close()
+{
+	if (file) std::fclose(file);
+	file = nullptr;
+}
+
+void JournalWriter::write(const JournalRecord& record)
+{
+	if (file) std::fwrite(&record, sizeof(record), 1, file);
+}
+
+void JournalWriter::writeOrder(const Order& order, TimeStamp time)
+{
+	JournalRecord record = {};
+	record.type = JournalRecordType::NewOrder;
+	record.time = time;
+	record.order = order;
+	lastTime = time;
+	write(record);
+}
+
+void JournalWriter::writeCancel(OrderId orderId)
+{
+	JournalRecord record = {};
+	record.type = JournalRecordType::Cancel;
+	record.time = lastTime;
+	record.cancelId = orderId;
+	write(record);
+}
+
+void JournalWriter::writeAmend(OrderId orderId, Ticks price, Volume volume, TimeStamp time)
+{
+	JournalRecord record = {};
+	record.type = JournalRecordType::Amend;
+	record.time = time;
+	record.amend = { orderId, price, volume };
+	lastTime = time;
+	write(record);
+}
+
+void JournalWriter::writeStop(const Order& order, Ticks triggerPrice, StopKind kind, TimeStamp time)
+{
+	JournalRecord record = {};
+	record.type = JournalRecordType::Stop;
+	record.time = time;
+	record.stop = { order.id, order.traderId, order.price, order.volume, order.side, kind, triggerPrice };
+	lastTime = time;
+	write(record);
+}
+
+void JournalWriter::writeTrade(const TradeRecord& trade)
+{
+	JournalRecord record = {};
+	record.type = JournalRecordType::Trade;
+	record.time = trade.timeStamp;
+	record.trade = trade;
+	write(record);
+}
+
+static bool sameTrade(const TradeRecord& a, const TradeRecord& b)
+{
+	return a.tradeId == b.tradeId && a.price == b.price && a.volume == b.volume
+		&& a.buyerId == b.buyerId && a.sellerId == b.sellerId && a.timeStamp == b.timeStamp;
+}
+
+//Trades the replayed book printed that no Trade record has been checked against yet.
+//printed[i] is trade number first + i of the replay.
+class PrintedTrades : public BookListener
+{
+public:
+	std::vector<TradeRecord> printed;
+	size_t first = 0;
+
+	void onLevel(const LevelDelta& delta) override { (void)delta; }
+	void onTrade(const TradeRecord& trade) override { printed.push_back(trade); }
+
+	const TradeRecord* find(size_t index) const
+	{
+		if (index < first || index - first >= printed.size()) return nullptr;
+		return &printed[index - first];
+	}
+
+	//Drops checked trades once they are at least half the buffer, so a long sweep isn't shifted per row
+	void forgetBefore(size_t index)
+	{
+		if (index <= first) return;
+
+		size_t drop = std::min(index - first, printed.size());
+		if (drop * 2 < printed.size()) return;
+
+		printed.erase(printed.begin(), printed.begin() + static_cast<ptrdiff_t>(drop));
+		first += drop;
+	}
+};
+
+ReplayResult replayJournal(const std::string& path)
+{
+	ReplayResult result;
+
+	MappedFile mapped;
+	if (!mapped.open(path) || mapped.getSize() < sizeof(JournalHeader)) return result;
+
+	JournalHeader header;
+	std::memcpy(&header, mapped.getData(), sizeof(header));
+	if (std::memcmp(header.magic, JournalMagic, sizeof(JournalMagic)) != 0
+		|| header.version < 1 || header.version > JournalVersion
+		|| header.recordSize != sizeof(JournalRecord)) {
+		return result;
+	}
+
+	result.opened = true;
+
+	const unsigned char* begin = mapped.getData() + sizeof(JournalHeader);
+	size_t recordCount = (mapped.getSize() - sizeof(JournalHeader)) / sizeof(JournalRecord);
+
+	//Trades are checked as they print, however many one order fills, so no history is kept
+	LimitOrderBook LOB;
+	PrintedTrades printed;
+	LOB.addListener(&printed);
+	LOB.setHistoryRetention(0, 0);
+	Clock clock;
+	size_t checkedTrades = 0;
+
+	//Runs of new orders at the same time go through the book as one batch
+	std::vector<Command> batch;
+	std::vector<OrderId> expectedIds;
+	std::vector<CommandResult> results;
+
+	auto flush = [&]() {
+		if (batch.empty()) return;
+
+		results.resize(batch.size());
+		LOB.processBatch(batch.data(), batch.size(), results.data(), clock);
+
+		for (size_t k = 0; k < batch.size(); k++) {
+			if (results[k].orderId != expectedIds[k]) result.mismatches++;
+		}
+
+		batch.clear();
+		expectedIds.clear();
+	};
+
+	for (size_t i = 0; i < recordCount; i++)
+	{
+		JournalRecord record;
+		std::memcpy(&record, begin + i * sizeof(JournalRecord), sizeof(record));
+
+		if (record.type != JournalRecordType::NewOrder || record.time > clock.now()) flush();
+		if (record.time > clock.now()) clock.advance(record.time - clock.now());
+
+		switch (record.type)
+		{
+		case JournalRecordType::NewOrder:
+			batch.push_back(makeOrderCommand(record.order, false));
+			expectedIds.push_back(record.order.id);
+			result.orders++;
+			break;
+		case JournalRecordType::Cancel:
+			LOB.cancelOrder(record.cancelId);
+			result.cancels++;
+			break;
+		case JournalRecordType::Amend:
+			LOB.amendOrder(record.amend.orderId, record.amend.price, record.amend.volume, clock);
+			result.amends++;
+			break;
+		case JournalRecordType::Stop:
+		{
+			const StopRecord& stop = record.stop;
+			Order order = { 0, stop.traderId, stop.limitPrice, stop.volume, stop.side, record.time };
+			StopKind kind = stop.kind;
+			if (header.version < 4) kind = (stop.limitPrice == 0) ? StopKind::Market : StopKind::Limit;
+			if (LOB.placeStop(order, stop.triggerPrice, kind, clock) != stop.orderId) result.mismatches++;
+			result.stops++;
+			break;
+		}
+		case JournalRecordType::Trade:
+		{
+			const TradeRecord* trade = printed.find(checkedTrades);
+			if (!trade || !sameTrade(*trade, record.trade)) result.mismatches++;
+			printed.forgetBefore(++checkedTrades);
+			result.trades++;
+			break;
+		}
+		default:
+			result.mismatches++;
+			break;
+		}
+	}
+
+	flush();
+
+	//Trades the replay produced that were never recorded
+	if (LOB.getTradeCount() > checkedTrades) result.mismatches += LOB.getTradeCount() - checkedTrades;
+
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+
+#include "datatypes.h"
+
+enum class JournalRecordType : uint8_t
+{
+	NewOrder = 1,
+	Cancel = 2,
+	Trade = 3,
+	Amend = 4,
+	Stop = 5
+};
+
+struct AmendRecord
+{
+	OrderId orderId;
+	Ticks price;
+	Volume volume;
+};
+
+//A stop as placed, the order's time is the record's
+struct StopRecord
+{
+	OrderId orderId;
+	TraderId traderId;
+	Ticks limitPrice;
+	Volume volume;
+	Side side;
+	StopKind kind; //Version 4 on, older stops are market stops when limitPrice is 0
+	Ticks triggerPrice;
+};
+
+//Fixed-size so a mapped journal can be walked as an array
+struct JournalRecord
+{
+	JournalRecordType type;
+	uint8_t reserved[3];
+	TimeStamp time; //Clock time the book saw the command, cancels carry the last known time
+	union
+	{
+		Order order; //As accepted, with the id the book assigned
+		OrderId cancelId;
+		TradeRecord trade;
+		AmendRecord amend;
+		StopRecord stop;
+	};
+};
+
+static_assert(sizeof(JournalRecord) == 32, "JournalRecord is part of the file format");
+
+struct JournalHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t recordSize;
+	uint32_t reserved;
+};
+
+//Append-only binary log of every command the book accepts and every trade it produces
+class JournalWriter
+{
+private:
+	std::FILE* file = nullptr;
+	TimeStamp lastTime = 0;
+
+	void write(const JournalRecord& record);
+public:
+	JournalWriter() = default;
+	~JournalWriter();
+
+	JournalWriter(const JournalWriter&) = delete;
+	JournalWriter& operator=(const JournalWriter&) = delete;
+
+	bool open(const std::string& path);
+	void close();
+	bool isOpen() const { return file != nullptr; }
+
+	void writeOrder(const Order& order, TimeStamp time);
+	void writeCancel(OrderId orderId);
+	void writeAmend(OrderId orderId, Ticks price, Volume volume, TimeStamp time);
+	void writeStop(const Order& order, Ticks triggerPrice, StopKind kind, TimeStamp time);
+	void writeTrade(const TradeRecord& trade);
+};
+
+struct ReplayResult
+{
+	bool opened = false;
+	size_t orders = 0;
+	size_t cancels = 0;
+	size_t amends = 0;
+	size_t stops = 0;
+	size_t trades = 0;
+	size_t mismatches = 0; //Recorded trades or order ids the replayed book didn't reproduce
+};
+
+//Drives a fresh book from a mapped journal and checks it reproduces the recorded trades
+ReplayResult replayJournal(const std::string& path);
\ No newline at end of file
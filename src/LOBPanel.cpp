@@ -1,103 +1,107 @@
 #include "LOBPanel.h"
+#include <algorithm>
+#include <string_view>
 #include <SFML/Graphics/RenderWindow.hpp>
 #include "UIHelpers.h"
+#include "Profiler.h"
 
-void LOBPanel::draw(sf::RenderWindow& window, const sf::Font& font, const LimitOrderBook& LOB, float lobWidth)
+void LOBPanel::draw(sf::RenderWindow& window, const sf::Font& font, const BookSnapshot& snapshot, float lobWidth)
 {
-	//Draw LOBPanel
+	MARKETSIM_PROFILE_SCOPE(Probe::LOBPanelDraw);
 
 	float winHeight = static_cast<float>(window.getSize().y);
-	UIHelper::drawColoredRect(window, 0.f, 0.f, lobWidth, winHeight, TextSnap::Left, 0.f, Theme::Surface);
+
+	batch.setFont(font);
+	if (snapshot.sequence != builtSequence || lobWidth != builtWidth || winHeight != builtHeight) {
+		build(snapshot, lobWidth, winHeight);
+		builtSequence = snapshot.sequence;
+		builtWidth = lobWidth;
+		builtHeight = winHeight;
+	}
+
+	window.draw(batch);
+}
+
+void LOBPanel::build(const BookSnapshot& snapshot, float lobWidth, float winHeight)
+{
+	batch.clear();
+
+	char number[UIHelper::NumberBufferSize];
+
+	//Draw LOBPanel
+
+	batch.addRect(0.f, 0.f, lobWidth, winHeight, TextSnap::Left, 0.f, Theme::Surface);
 
 	//Draw Label Text
 
-	UIHelper::drawLabel(window, font, "BIDS ($)", 28, lobWidth / 4.f, 20.f, TextSnap::Center, 0.f, Theme::Bid);
-	UIHelper::drawLabel(window, font, "ASKS ($)", 28, 3.f * lobWidth / 4.f, 20.f, TextSnap::Center, 0.f, Theme::Ask);
+	batch.addText("BIDS ($)", 28, lobWidth / 4.f, 20.f, TextSnap::Center, 0.f, Theme::Bid);
+	batch.addText("ASKS ($)", 28, 3.f * lobWidth / 4.f, 20.f, TextSnap::Center, 0.f, Theme::Ask);
 
 	//Draw LOBPanel
 
-	const auto& bids = LOB.getBids();
-	const auto& asks = LOB.getAsks();
+	const std::vector<LevelInfo>& bidLevels = snapshot.bids;
+	const std::vector<LevelInfo>& askLevels = snapshot.asks;
 
 	float rowHeight = 30.f;
 	float padding = 5.f;
 	float currentY = 130.f;
 
-	if (!bids.empty() && !asks.empty())
+	//Whole part snapped right of the center line, decimals snapped left of it
+	auto addSplitPrice = [&](double price, unsigned fontSize, float x, float y, float offset, sf::Color color) {
+		std::string_view fullPrice(number, UIHelper::formatPrice(price, number));
+		size_t dotPos = fullPrice.find('.');
+
+		batch.addText(fullPrice.substr(0, dotPos), fontSize, x, y, TextSnap::Right, offset, color);
+		batch.addText(fullPrice.substr(dotPos), fontSize, x, y, TextSnap::Left, offset, color);
+	};
+
+	if (!bidLevels.empty() && !askLevels.empty())
 	{
-		double bestBid = bids.begin()->first;
-		double bestAsk = asks.begin()->first;
+		double bestBid = toPrice(bidLevels.front().price);
+		double bestAsk = toPrice(askLevels.front().price);
 		double mid = (bestBid + bestAsk) / 2.0;
 		double spread = bestAsk - bestBid;
 
 		float centerX = lobWidth / 2.f;
 
-		std::string fullPrice = UIHelper::formatPrice(mid);
-		size_t dotPos = fullPrice.find('.');
-
-		std::string leftSide = fullPrice.substr(0, dotPos);
-		std::string rightSide = fullPrice.substr(dotPos);
-		UIHelper::drawLabel(window, font, leftSide, 30, centerX, 3.f * currentY / 4.f, TextSnap::Right, -9.f, Theme::TextDim);
-		UIHelper::drawLabel(window, font, rightSide, 30, centerX, 3.f * currentY / 4.f, TextSnap::Left, -9.f, Theme::TextDim);
+		addSplitPrice(mid, 30, centerX, 3.f * currentY / 4.f, -9.f, Theme::TextDim);
+		addSplitPrice(spread, 22, centerX, currentY / 2.f, -7.f, Theme::Accent);
 
-		fullPrice = UIHelper::formatPrice(spread);
-		dotPos = fullPrice.find('.');
+		size_t bidCount = std::min(bidLevels.size(), MaxLevels);
+		size_t askCount = std::min(askLevels.size(), MaxLevels);
 
-		leftSide = fullPrice.substr(0, dotPos);
-		rightSide = fullPrice.substr(dotPos);
-		UIHelper::drawLabel(window, font, leftSide, 22, centerX, currentY / 2.f, TextSnap::Right, -7.f, Theme::Accent);
-		UIHelper::drawLabel(window, font, rightSide, 22, centerX, currentY / 2.f, TextSnap::Left, -7.f, Theme::Accent);
-
-		int count = 0;
-		int maxCount = 25; //Price levels to show
-		long maxVol = std::max(LOB.getHighestVolume(BUY, maxCount), LOB.getHighestVolume(SELL, maxCount));
+		long maxVol = 0;
+		for (size_t i = 0; i < bidCount; i++) maxVol = std::max(maxVol, bidLevels[i].volume);
+		for (size_t i = 0; i < askCount; i++) maxVol = std::max(maxVol, askLevels[i].volume);
 
 		if (maxVol == 0)
 			return;
 
-		count = 0;
-		for (auto it = bids.begin(); it != bids.end() && count < maxCount; ++it) {
-			if (it->second.empty())
-				continue;
-
-			long onePriceVol = 0;
-			for (const auto& order : it->second)
-				onePriceVol += order.volume;
+		for (size_t count = 0; count < bidCount; ++count) {
+			long onePriceVol = bidLevels[count].volume;
 
 			float fullPerc = static_cast<float>(onePriceVol) / maxVol;
 			float yPos = currentY + (rowHeight + padding) * count;
-			float centerX = lobWidth / 2.f;
-
-			UIHelper::drawColoredRect(window, centerX, yPos, centerX * fullPerc, rowHeight, TextSnap::Right, 0.f, Theme::BidBG);
 
-			UIHelper::drawLabel(window, font, UIHelper::formatPrice(it->first), 24, centerX, yPos, TextSnap::Right, -10.f, Theme::Bid);
-			UIHelper::drawLabel(window, font, std::to_string(onePriceVol), 22, 0.f, yPos, TextSnap::Left, 10.f, Theme::TextDim);
+			batch.addRect(centerX, yPos, centerX * fullPerc, rowHeight, TextSnap::Right, 0.f, Theme::BidBG);
 
-			++count;
+			batch.addText({ number, UIHelper::formatPrice(toPrice(bidLevels[count].price), number) }, 24, centerX, yPos, TextSnap::Right, -10.f, Theme::Bid);
+			batch.addText({ number, UIHelper::formatVolume(onePriceVol, number) }, 22, 0.f, yPos, TextSnap::Left, 10.f, Theme::TextDim);
 		}
 
-		count = 0;
-		for (auto it = asks.begin(); it != asks.end() && count < maxCount; ++it) {
-			if (it->second.empty())
-				continue;
-
-			long onePriceVol = 0;
-			for (const auto& order : it->second)
-				onePriceVol += order.volume;
+		for (size_t count = 0; count < askCount; ++count) {
+			long onePriceVol = askLevels[count].volume;
 
 			float fullPerc = static_cast<float>(onePriceVol) / maxVol;
 			float yPos = currentY + (rowHeight + padding) * count;
-			float centerX = lobWidth / 2.f;
-
-			UIHelper::drawColoredRect(window, centerX, yPos, centerX * fullPerc, rowHeight, TextSnap::Left, 0.f, Theme::AskBG);
 
-			UIHelper::drawLabel(window, font, UIHelper::formatPrice(it->first), 24, centerX, yPos, TextSnap::Left, 10.f, Theme::Ask);
-			UIHelper::drawLabel(window, font, std::to_string(onePriceVol), 22, lobWidth, yPos, TextSnap::Right, -10.f, Theme::TextDim);
+			batch.addRect(centerX, yPos, centerX * fullPerc, rowHeight, TextSnap::Left, 0.f, Theme::AskBG);
 
-			++count;
+			batch.addText({ number, UIHelper::formatPrice(toPrice(askLevels[count].price), number) }, 24, centerX, yPos, TextSnap::Left, 10.f, Theme::Ask);
+			batch.addText({ number, UIHelper::formatVolume(onePriceVol, number) }, 22, lobWidth, yPos, TextSnap::Right, -10.f, Theme::TextDim);
 		}
 	}
 
-	UIHelper::drawColoredRect(window, lobWidth, 0.f, 2.f, window.getSize().y, TextSnap::Left, 0.f, Theme::Border);
-	UIHelper::drawColoredRect(window, lobWidth / 2.f, currentY, 2.f, window.getSize().y, TextSnap::Center, 0.f, Theme::Border);
+	batch.addRect(lobWidth, 0.f, 2.f, winHeight, TextSnap::Left, 0.f, Theme::Border);
+	batch.addRect(lobWidth / 2.f, currentY, 2.f, winHeight, TextSnap::Center, 0.f, Theme::Border);
 }
\ No newline at end of file
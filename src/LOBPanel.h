@@ -5,11 +5,21 @@ namespace sf {
     class Font;
 }
 
-#include "LimitOrderBook.h"
+#include "SimulationThread.h"
+#include "QuadBatch.h"
 
 class LOBPanel
 {
 private:
+	static constexpr size_t MaxLevels = 25; //Price levels to show
+
+	//Rebuilt only when a new snapshot arrives or the layout changes, drawn every frame
+	QuadBatch batch;
+	uint64_t builtSequence = 0;
+	float builtWidth = 0.f;
+	float builtHeight = 0.f;
+
+	void build(const BookSnapshot& snapshot, float lobWidth, float winHeight);
 public:
-	void draw(sf::RenderWindow& window, const sf::Font& font, const LimitOrderBook& LOB, float lobWidth);
+	void draw(sf::RenderWindow& window, const sf::Font& font, const BookSnapshot& snapshot, float lobWidth);
 };
\ No newline at end of file
@@ -8,287 +8,716 @@
 #include <chrono>
 
 #include "datatypes.h"
-#include "UIHelpers.h"
 #include "LimitOrderBook.h"
 #include "Clock.h"
+#include "Profiler.h"
 
-static double roundToTick(double price, double tickSize = 0.01) {
-	return std::round(price / tickSize) * tickSize;
+LimitOrderBook::LimitOrderBook(SymbolId symbol)
+	: symbol(symbol)
+{}
+
+SymbolId LimitOrderBook::getSymbol() const
+{
+	return symbol;
 }
 
-const std::map<double, std::list<Order>, std::greater<double>>& LimitOrderBook::getBids() const
+const BookLevels<BUY>& LimitOrderBook::getBids() const
 {
 	return bids;
 }
 
-const std::map<double, std::list<Order>>& LimitOrderBook::getAsks() const
+const BookLevels<SELL>& LimitOrderBook::getAsks() const
 {
 	return asks;
 }
 
-const Trader* LimitOrderBook::getTrader(long id) const {
-	auto it = traders.find(id);
-	if (it != traders.end()) {
-		return it->second;
-	}
-	return nullptr;
+template<Side S>
+BookLevels<S>& LimitOrderBook::levels()
+{
+	if constexpr (S == BUY) return bids;
+	else return asks;
 }
 
-long LimitOrderBook::getHighestVolume(Side side, size_t priceLevels) const
+template<Side S>
+const BookLevels<S>& LimitOrderBook::levels() const
 {
-	long onePriceVol = 0;
-	long maxVol = 0;
+	if constexpr (S == BUY) return bids;
+	else return asks;
+}
 
-	int count = 0;
+template<Side S>
+bool LimitOrderBook::crosses(Ticks limitPrice) const
+{
+	const auto& resting = levels<BookSide<S>::opposite>();
+	return !resting.empty() && BookSide<S>::canTake(limitPrice, resting.bestPrice());
+}
+
+bool LimitOrderBook::crosses(const Order& order) const
+{
+	return (order.side == Side::BUY) ? crosses<BUY>(order.price) : crosses<SELL>(order.price);
+}
 
+template<class Levels>
+static long highestVolume(const Levels& levels, size_t priceLevels)
+{
+	long maxVol = 0;
+	size_t count = 0;
+	for (auto it = levels.begin(); it != levels.end() && count < priceLevels; ++it, ++count) {
+		if (it->totalVolume > maxVol) maxVol = it->totalVolume;
+	}
+	return maxVol;
+}
+
+long LimitOrderBook::getHighestVolume(Side side, size_t priceLevels) const
+{
 	if (bids.empty() || asks.empty())
 	{
 		return 0;
 	}
 
-	if (side == Side::BUY)
-	{
-		for (auto it = bids.begin(); it != bids.end() && count < priceLevels; ++it, ++count) {
-			onePriceVol = 0;
-			for (const auto& order : it->second) onePriceVol += order.volume;
-			if (onePriceVol > maxVol) maxVol = onePriceVol;
-		}
-	}
-	else
-	{
-		for (auto it = asks.begin(); it != asks.end() && count < priceLevels; ++it, ++count) {
-			onePriceVol = 0;
-			for (const auto& order : it->second) onePriceVol += order.volume;
-			if (onePriceVol > maxVol) maxVol = onePriceVol;
-		}
+	return (side == Side::BUY) ? highestVolume(bids, priceLevels) : highestVolume(asks, priceLevels);
+}
+
+long LimitOrderBook::getVolumeAt(Side side, Ticks price) const
+{
+	const PriceLevel* level = (side == Side::BUY) ? bids.find(price) : asks.find(price);
+	return level ? level->totalVolume : 0;
+}
+
+template<class Levels>
+static size_t topLevels(const Levels& levels, LevelInfo* out, size_t count)
+{
+	size_t filled = 0;
+	for (auto it = levels.begin(); it != levels.end() && filled < count; ++it) {
+		out[filled++] = { it->price, it->totalVolume, it->orderCount };
 	}
+	return filled;
+}
 
-	return maxVol;
+std::vector<LevelInfo> LimitOrderBook::getTopLevels(Side side, size_t count) const
+{
+	std::vector<LevelInfo> top(std::min(count, (side == Side::BUY) ? bids.size() : asks.size()));
+	top.resize(getTopLevels(side, top.data(), top.size()));
+	return top;
+}
+
+size_t LimitOrderBook::getTopLevels(Side side, LevelInfo* out, size_t count) const
+{
+	return (side == Side::BUY) ? topLevels(bids, out, count) : topLevels(asks, out, count);
+}
+
+template<Side S>
+static long cumulativeDepth(const BookLevels<S>& levels, Ticks limitPrice)
+{
+	long depth = 0;
+	for (auto it = levels.begin(); it != levels.end() && BookSide<S>::atOrBetter(it->price, limitPrice); ++it) depth += it->totalVolume;
+	return depth;
+}
+
+long LimitOrderBook::getCumulativeDepth(Side side, Ticks limitPrice) const
+{
+	return (side == Side::BUY) ? cumulativeDepth<BUY>(bids, limitPrice) : cumulativeDepth<SELL>(asks, limitPrice);
 }
 
-void LimitOrderBook::update() {
+void LimitOrderBook::update(const Clock& clock) {
+	MARKETSIM_PROFILE_SCOPE(Probe::BookUpdate);
+
 	double midPrice;
 
 	if (bids.empty() && asks.empty()) {
 		midPrice = midPriceRecords.empty() ? 20.0 : midPriceRecords.back();
 	}
 	else if (bids.empty()) {
-		midPrice = asks.begin()->first;
+		midPrice = toPrice(asks.bestPrice());
 	}
 	else if (asks.empty()) {
-		midPrice = bids.begin()->first;
+		midPrice = toPrice(bids.bestPrice());
 	}
 	else {
-		midPrice = (bids.begin()->first + asks.begin()->first) / 2.0;
+		midPrice = toPrice(bids.bestPrice() + asks.bestPrice()) / 2.0;
 	}
 
-	midPriceRecords.push_back(midPrice);
+	midPriceRecords.push(static_cast<TimeStamp>(clock.now()), midPrice);
+	if (marketData) marketData->writeMidPrice(static_cast<TimeStamp>(clock.now()), midPrice);
+	indicators.push(midPrice);
 }
 
-const std::vector<TradeRecord>& LimitOrderBook::getTradeHistory() const
+const TradeHistory& LimitOrderBook::getTradeHistory() const
 {
 	return tradeRecords;
 }
 
-const std::vector<double>& LimitOrderBook::getMidPriceHistory() const
+const MidPriceHistory& LimitOrderBook::getMidPriceHistory() const
 {
 	return midPriceRecords;
 }
 
-long LimitOrderBook::processOrder(const Order& incomingOrder, Clock& clock)
+const MarketIndicators& LimitOrderBook::getIndicators() const
+{
+	return indicators;
+}
+
+void LimitOrderBook::setIndicatorWindows(const IndicatorWindows& windows)
+{
+	indicators.reset(windows);
+}
+
+size_t LimitOrderBook::getOrderCount() const
+{
+	return nextOrderId - 1;
+}
+
+size_t LimitOrderBook::getTradeCount() const
+{
+	return nextTradeId - 1;
+}
+
+long LimitOrderBook::getTradedVolume() const
 {
+	return tradedVolume;
+}
+
+OrderId LimitOrderBook::processOrder(const Order& incomingOrder, Clock& clock)
+{
+	MARKETSIM_PROFILE_SCOPE(Probe::ProcessOrder);
+
 	Order order = incomingOrder;
 	order.id = nextOrderId++;
 
-	order.price = roundToTick(order.price);
+	if (journal) journal->writeOrder(order, static_cast<TimeStamp>(clock.now()));
 
-	if (order.side == Side::BUY) {
-		if (!asks.empty() && order.price >= asks.begin()->first)
-			executeMatch(order, clock);
-		else
-			addLimitOrder(order);
-	}
-	else
-	{
-		if (!bids.empty() && order.price <= bids.begin()->first)
-			executeMatch(order, clock);
-		else
-			addLimitOrder(order);
-	}
+	route(order, clock);
 
 	return order.id;
 }
 
-void LimitOrderBook::executeMatch(Order& incomingOrder, Clock& clock)
+void LimitOrderBook::route(Order& order, Clock& clock)
 {
-	if (incomingOrder.side == Side::BUY) 
-	{
-		while (incomingOrder.volume > 0 && !asks.empty())
-		{
-			auto priceLevelIt = asks.begin();
+	if (crosses(order))
+		executeMatch(order, clock);
+	else
+		addLimitOrder(order);
 
-			if (priceLevelIt->first > incomingOrder.price) break;
+	if (!buyStops.empty() || !sellStops.empty()) releaseStops(clock);
+}
 
-			std::list<Order>& priceList = priceLevelIt->second;
-			while (incomingOrder.volume > 0 && !priceList.empty())
-			{
-				Order& restingOrder = priceList.front();
-				long tradeVolume = std::min(incomingOrder.volume, restingOrder.volume);
+OrderId LimitOrderBook::placeStop(const Order& order, Ticks triggerPrice, StopKind kind, Clock& clock)
+{
+	Order stop = order;
+	stop.id = nextOrderId++;
+	stop.timeStamp = static_cast<TimeStamp>(clock.now());
 
-				recordTrade(incomingOrder, restingOrder, tradeVolume, priceLevelIt->first, clock);
-				lastTradePrice = priceLevelIt->first;
+	if (journal) journal->writeStop(stop, triggerPrice, kind, stop.timeStamp);
 
+	StopTerms terms = { stop.price, kind };
+	stop.price = triggerPrice;
 
+	uint32_t slot = stopPool.allocate(stop);
+	if (slot >= stopTerms.size()) stopTerms.resize(stopPool.capacity());
+	stopTerms[slot] = terms;
 
-				restingOrder.volume -= tradeVolume;
-				incomingOrder.volume -= tradeVolume;
+	if (stop.side == Side::BUY) stopPool.pushBack(buyStops.get(triggerPrice), slot);
+	else stopPool.pushBack(sellStops.get(triggerPrice), slot);
 
-				if (restingOrder.volume == 0) {
-					orderLookup.erase(restingOrder.id);
-					priceList.pop_front();
-				}
-			}
+	//The last trade may already be through the trigger
+	releaseStops(clock);
 
-			if (priceList.empty()) {
-				asks.erase(priceLevelIt);
-			}
+	return stop.id;
+}
+
+void LimitOrderBook::releaseStops(Clock& clock)
+{
+	//Stops released below route back through here, the outer loop picks up whatever they trigger
+	if (releasingStops || !hasLastTrade) return;
+	releasingStops = true;
+
+	while (true)
+	{
+		bool buyDue = !buyStops.empty() && lastTradePrice >= buyStops.bestPrice();
+		bool sellDue = !sellStops.empty() && lastTradePrice <= sellStops.bestPrice();
+		if (!buyDue && !sellDue) break;
+
+		if (buyDue && sellDue) {
+			buyDue = stopPool[buyStops.best().head].order.id < stopPool[sellStops.best().head].order.id;
+		}
+
+		PriceLevel& level = buyDue ? buyStops.best() : sellStops.best();
+		uint32_t slot = level.head;
+
+		StopTerms terms = stopTerms[slot];
+		Order order = stopPool[slot].order;
+		order.price = terms.limitPrice;
+		order.timeStamp = static_cast<TimeStamp>(clock.now());
+		firedStops[order.side]++;
+
+		stopPool.unlink(level, slot);
+		stopPool.release(slot);
+		if (level.empty()) {
+			if (buyDue) buyStops.erase(level.price);
+			else sellStops.erase(level.price);
+		}
+
+		if (terms.kind == StopKind::Limit) {
+			route(order, clock);
+			continue;
 		}
+
+		//Market: take whatever the other side has and drop the rest
+		order.price = (order.side == Side::BUY) ? BookSide<BUY>::marketPrice : BookSide<SELL>::marketPrice;
+		if (crosses(order)) executeMatch(order, clock, false);
 	}
-	else
-	{
-		while (incomingOrder.volume > 0 && !bids.empty())
-		{
-			auto priceLevelIt = bids.begin();
 
-			if (priceLevelIt->first < incomingOrder.price) break;
+	releasingStops = false;
+}
+
+bool LimitOrderBook::cancelStop(OrderId orderId)
+{
+	uint32_t slot = stopPool.find(orderId);
+	if (slot == NilSlot) return false;
 
-			std::list<Order>& priceList = priceLevelIt->second;
-			while (incomingOrder.volume > 0 && !priceList.empty())
-			{
-				Order& restingOrder = priceList.front();
-				long tradeVolume = std::min(incomingOrder.volume, restingOrder.volume);
+	const Order& stop = stopPool[slot].order;
+	Ticks triggerPrice = stop.price;
 
-				recordTrade(restingOrder, incomingOrder, tradeVolume, priceLevelIt->first, clock);
-				lastTradePrice = priceLevelIt->first;
+	PriceLevel* level = (stop.side == Side::BUY) ? buyStops.find(triggerPrice) : sellStops.find(triggerPrice);
+	stopPool.unlink(*level, slot);
+	if (level->empty()) {
+		if (stop.side == Side::BUY) buyStops.erase(triggerPrice);
+		else sellStops.erase(triggerPrice);
+	}
 
-				restingOrder.volume -= tradeVolume;
-				incomingOrder.volume -= tradeVolume;
+	stopPool.release(slot);
+	return true;
+}
 
-				if (restingOrder.volume == 0) {
-					orderLookup.erase(restingOrder.id);
-					priceList.pop_front();
-				}
-			}
+size_t LimitOrderBook::getStopCount() const
+{
+	return stopPool.size();
+}
 
-			if (priceList.empty()) {
-				bids.erase(priceLevelIt);
+size_t LimitOrderBook::getFiredStopCount(Side side) const
+{
+	return static_cast<size_t>(firedStops[side]);
+}
+
+template<Side S>
+void LimitOrderBook::match(Order& incomingOrder, Clock& clock)
+{
+	constexpr Side Opposite = BookSide<S>::opposite;
+	BookLevels<Opposite>& resting = levels<Opposite>();
+
+	while (incomingOrder.volume > 0 && !resting.empty())
+	{
+		PriceLevel& priceLevel = resting.best();
+
+		if (!BookSide<S>::canTake(incomingOrder.price, priceLevel.price)) break;
+
+		while (incomingOrder.volume > 0 && !priceLevel.empty())
+		{
+			uint32_t slot = priceLevel.head;
+			Order& restingOrder = orderPool[slot].order;
+			Volume tradeVolume = std::min(incomingOrder.volume, restingOrder.volume);
+
+			if constexpr (S == BUY) recordTrade(incomingOrder, restingOrder, tradeVolume, priceLevel.price, clock);
+			else recordTrade(restingOrder, incomingOrder, tradeVolume, priceLevel.price, clock);
+			lastTradePrice = priceLevel.price;
+			hasLastTrade = true;
+
+			restingOrder.volume -= tradeVolume;
+			priceLevel.totalVolume -= tradeVolume;
+			incomingOrder.volume -= tradeVolume;
+
+			if (restingOrder.volume == 0) {
+				orderPool.unlink(priceLevel, slot);
+				orderPool.release(slot);
 			}
 		}
+
+		if (priceLevel.empty()) {
+			if (!listeners.empty()) publishLevel(Opposite, priceLevel, LevelChange::Removed);
+			resting.erase(priceLevel.price);
+		}
+		else if (!listeners.empty()) {
+			publishLevel(Opposite, priceLevel, LevelChange::Changed);
+		}
 	}
+}
+
+void LimitOrderBook::executeMatch(Order& incomingOrder, Clock& clock, bool restRemainder)
+{
+	MARKETSIM_PROFILE_SCOPE(Probe::ExecuteMatch);
+
+	if (incomingOrder.side == Side::BUY) match<BUY>(incomingOrder, clock);
+	else match<SELL>(incomingOrder, clock);
 
-	if (incomingOrder.volume > 0) {
+	if (incomingOrder.volume > 0 && restRemainder) {
 		addLimitOrder(incomingOrder);
 	}
 }
 
-bool LimitOrderBook::cancelOrder(long orderId)
+bool LimitOrderBook::cancelOrder(OrderId orderId)
 {
-	auto mapIt = orderLookup.find(orderId);
+	MARKETSIM_PROFILE_SCOPE(Probe::CancelOrder);
 
-	if (mapIt == orderLookup.end()) {
-		return false;
+	if (journal) journal->writeCancel(orderId);
+
+	uint32_t slot = orderPool.find(orderId);
+
+	if (slot == NilSlot) {
+		return stopPool.size() > 0 && cancelStop(orderId);
 	}
 
-	std::list<Order>::iterator listIt = mapIt->second;
-	const Order& orderToCancel = *listIt;
+	if (marketData) marketData->writeOrderCancelled(orderPool[slot].order);
 
-	if (orderToCancel.side == Side::BUY) {
-		auto priceLevelIt = bids.find(orderToCancel.price);
+	removeOrder(slot);
+	return true;
+}
 
-		if (priceLevelIt != bids.end()) {
-			priceLevelIt->second.erase(listIt);
-			if (priceLevelIt->second.empty()) {
-				bids.erase(priceLevelIt);
-			}
+template<Side S>
+void LimitOrderBook::unlink(uint32_t slot)
+{
+	Ticks price = orderPool[slot].order.price;
+	PriceLevel* priceLevel = levels<S>().find(price);
+
+	if (priceLevel) {
+		orderPool.unlink(*priceLevel, slot);
+		if (!listeners.empty()) publishLevel(S, *priceLevel, priceLevel->empty() ? LevelChange::Removed : LevelChange::Changed);
+		if (priceLevel->empty()) {
+			levels<S>().erase(price);
 		}
 	}
-	else {
-		auto priceLevelIt = asks.find(orderToCancel.price);
+}
 
-		if (priceLevelIt != asks.end()) {
-			priceLevelIt->second.erase(listIt);
-			if (priceLevelIt->second.empty()) {
-				asks.erase(priceLevelIt);
-			}
-		}
+void LimitOrderBook::removeOrder(uint32_t slot)
+{
+	if (orderPool[slot].order.side == Side::BUY) unlink<BUY>(slot);
+	else unlink<SELL>(slot);
+
+	orderPool.release(slot);
+}
+
+bool LimitOrderBook::amendOrder(OrderId orderId, Ticks newPrice, Volume newVolume, Clock& clock)
+{
+	TimeStamp now = static_cast<TimeStamp>(clock.now());
+	if (journal) journal->writeAmend(orderId, newPrice, newVolume, now);
+
+	uint32_t slot = orderPool.find(orderId);
+
+	if (slot == NilSlot) {
+		return false;
+	}
+
+	Order& order = orderPool[slot].order;
+
+	if (newVolume <= 0) {
+		if (marketData) marketData->writeOrderCancelled(order);
+		removeOrder(slot);
+		return true;
 	}
 
-	orderLookup.erase(mapIt);
+	//Same price and no more volume keeps the queue position, so it is just a volume change
+	if (newPrice == order.price && newVolume <= order.volume) {
+		PriceLevel* priceLevel = (order.side == Side::BUY) ? bids.find(order.price) : asks.find(order.price);
+
+		priceLevel->totalVolume -= order.volume - newVolume;
+		order.volume = newVolume;
+
+		if (marketData) marketData->writeOrderAmended(order, now);
+		if (!listeners.empty()) publishLevel(order.side, *priceLevel, LevelChange::Changed);
+		return true;
+	}
+
+	//Anything else loses priority: leave the level and come back in as if new, under the same id
+	Order amended = order;
+	amended.price = newPrice;
+	amended.volume = newVolume;
+	amended.timeStamp = now;
+
+	if (marketData) marketData->writeOrderCancelled(order);
+	removeOrder(slot);
+
+	route(amended, clock);
 	return true;
 }
 
-void LimitOrderBook::registerTrader(Trader* trader) {
-	traders[trader->getId()] = trader;
+CommandResult LimitOrderBook::applyCommand(const Command& command, Clock& clock)
+{
+	switch (command.type)
+	{
+	case CommandType::NewOrder:
+		return { processOrder(command.order, clock), true };
+	case CommandType::Cancel:
+		return { command.targetId, cancelOrder(command.targetId) };
+	case CommandType::Amend:
+		return { command.targetId, amendOrder(command.targetId, command.order.price, command.order.volume, clock) };
+	case CommandType::Quote:
+		massQuote(command.order.traderId, command.order, command.quoteAsk, clock);
+		return { 0, true };
+	case CommandType::Stop:
+		return { placeStop(command.order, command.triggerPrice, command.stopKind, clock), true };
+	}
+	return { 0, false };
 }
 
-void LimitOrderBook::addLimitOrder(Order incomingOrder)
+void LimitOrderBook::processBatch(const Command* commands, size_t count, CommandResult* results, Clock& clock)
 {
-	if (incomingOrder.side == Side::BUY) {
-		auto priceLevelIt = bids.find(incomingOrder.price);
+	TimeStamp now = static_cast<TimeStamp>(clock.now());
+
+	//Level the last passive order went to, reused while the following ones land on it too
+	PriceLevel* openLevel = nullptr;
+	Side openSide = Side::BUY;
+	uint32_t restingBefore = 0;
+
+	auto closeLevel = [&]() {
+		if (openLevel && !listeners.empty()) publishLevel(openSide, *openLevel, restingBefore == 0 ? LevelChange::Added : LevelChange::Changed);
+		openLevel = nullptr;
+	};
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const Command& command = commands[i];
+
+		if (command.type == CommandType::NewOrder) {
+			Order order = command.order;
+			if (!crosses(order)) {
+				MARKETSIM_PROFILE_SCOPE(Probe::ProcessOrder);
+
+				order.id = nextOrderId++;
+				if (journal) journal->writeOrder(order, now);
+
+				if (!openLevel || openSide != order.side || openLevel->price != order.price) {
+					closeLevel();
+					openLevel = (order.side == Side::BUY) ? &bids.get(order.price) : &asks.get(order.price);
+					openSide = order.side;
+					restingBefore = openLevel->orderCount;
+				}
+
+				orderPool.pushBack(*openLevel, orderPool.allocate(order));
+				if (marketData) marketData->writeOrderAdded(order);
 
-		if (priceLevelIt == bids.end()) {
-			auto result = bids.emplace(incomingOrder.price, std::list<Order>{});
-			priceLevelIt = result.first;
+				results[i] = { order.id, true };
+				continue;
+			}
 		}
 
-		std::list<Order>::iterator newOrderIt = priceLevelIt->second.insert(
-			priceLevelIt->second.end(),
-			std::move(incomingOrder)
-		);
-		orderLookup.emplace(newOrderIt->id, newOrderIt);
+		closeLevel();
+		results[i] = applyCommand(command, clock);
 	}
-	else
-	{
-		auto priceLevelIt = asks.find(incomingOrder.price);
 
-		if (priceLevelIt == asks.end()) {
-			auto result = asks.emplace(incomingOrder.price, std::list<Order>{});
-			priceLevelIt = result.first;
+	closeLevel();
+}
+
+QuoteIds LimitOrderBook::massQuote(TraderId traderId, const Order& bid, const Order& ask, Clock& clock)
+{
+	QuoteIds& quote = quotes[traderId];
+
+	//Amend the live side in place where possible, otherwise place it fresh
+	auto replace = [&](OrderId& id, const Order& order) {
+		if (id != 0 && orderPool.find(id) != NilSlot) {
+			amendOrder(id, order.price, order.volume, clock);
+			if (order.volume <= 0) id = 0;
 		}
+		else if (order.volume > 0) {
+			id = processOrder(order, clock);
+		}
+		else {
+			id = 0;
+		}
+	};
+
+	//A side may not trade with the trader's own quote: pull the other side first if it would
+	auto pullCrossed = [&](OrderId& otherId, const Order& order) {
+		if (otherId == 0 || order.volume <= 0) return;
+
+		uint32_t slot = orderPool.find(otherId);
+		if (slot == NilSlot) return;
+
+		Ticks otherPrice = orderPool[slot].order.price;
+		bool crossesOwn = (order.side == Side::BUY) ? BookSide<BUY>::canTake(order.price, otherPrice) : BookSide<SELL>::canTake(order.price, otherPrice);
+		if (crossesOwn) {
+			cancelOrder(otherId);
+			otherId = 0;
+		}
+	};
+
+	pullCrossed(quote.askId, bid);
+	replace(quote.bidId, bid);
+	pullCrossed(quote.bidId, ask);
+	replace(quote.askId, ask);
 
-		std::list<Order>::iterator newOrderIt = priceLevelIt->second.insert(
-			priceLevelIt->second.end(),
-			std::move(incomingOrder)
-		);
-		orderLookup.emplace(newOrderIt->id, newOrderIt);
+	return quote;
+}
+
+void LimitOrderBook::setTraderRegistry(TraderRegistry* registry)
+{
+	this->registry = registry;
+}
+
+void LimitOrderBook::setJournal(JournalWriter* journal)
+{
+	this->journal = journal;
+}
+
+void LimitOrderBook::setMarketDataWriter(MarketDataWriter* writer)
+{
+	marketData = writer;
+}
+
+void LimitOrderBook::addListener(BookListener* listener)
+{
+	listeners.push_back(listener);
+}
+
+void LimitOrderBook::removeListener(BookListener* listener)
+{
+	listeners.erase(std::remove(listeners.begin(), listeners.end(), listener), listeners.end());
+}
+
+void LimitOrderBook::publishLevel(Side side, const PriceLevel& level, LevelChange change)
+{
+	LevelDelta delta = { side, change, level.price, 0, 0 };
+	if (change != LevelChange::Removed) {
+		delta.volume = level.totalVolume;
+		delta.orderCount = level.orderCount;
 	}
+
+	for (BookListener* listener : listeners) listener->onLevel(delta);
 }
 
-void LimitOrderBook::recordTrade(const Order& bidOrder, const Order& askOrder, long volume, double price, Clock& clock)
+void LimitOrderBook::setHistoryRetention(size_t trades, size_t midPrices)
 {
-	TradeRecord tradeRecord = {};
-	tradeRecord.buyerOrderId = bidOrder.traderId;
-	tradeRecord.sellerOrderId = askOrder.traderId;
-	tradeRecord.timeStamp = clock.now();
-	tradeRecord.tradeId = nextTradeId++;
-	tradeRecord.price = price;
-	tradeRecord.volume = volume;
-	tradeRecords.push_back(tradeRecord);
+	tradeRecords.setRetention(trades);
+	midPriceRecords.setRetention(midPrices);
+}
+
+template<class Levels>
+static void saveQueues(CheckpointWriter& writer, const Levels& levels, const OrderPool& pool, const std::vector<StopTerms>* terms)
+{
+	for (const PriceLevel& level : levels) {
+		for (uint32_t slot = level.head; slot != NilSlot; slot = pool[slot].next) {
+			writer.write(pool[slot].order);
+			if (terms) writer.write((*terms)[slot]);
+		}
+	}
+}
+
+void LimitOrderBook::saveState(CheckpointWriter& writer) const
+{
+	writer.write(nextOrderId);
+	writer.write(nextTradeId);
+	writer.write(lastTradePrice);
+	writer.write(tradedVolume);
+	writer.write<uint8_t>(hasLastTrade);
+	writer.write(firedStops);
+
+	writer.write<uint64_t>(orderPool.size());
+	saveQueues(writer, bids, orderPool, nullptr);
+	saveQueues(writer, asks, orderPool, nullptr);
+
+	writer.write<uint64_t>(stopPool.size());
+	saveQueues(writer, buyStops, stopPool, &stopTerms);
+	saveQueues(writer, sellStops, stopPool, &stopTerms);
+
+	writer.write<uint64_t>(quotes.size());
+	for (const auto& quote : quotes) {
+		writer.write(quote.first);
+		writer.write(quote.second);
+	}
+
+	tradeRecords.saveState(writer);
+	midPriceRecords.saveState(writer);
+	indicators.saveState(writer);
+}
+
+bool LimitOrderBook::loadState(CheckpointReader& reader)
+{
+	bids = BookLevels<BUY>();
+	asks = BookLevels<SELL>();
+	orderPool = OrderPool();
+	stopPool = OrderPool(256);
+	buyStops = PriceMap<SELL>();
+	sellStops = PriceMap<BUY>();
+	stopTerms.clear();
+	quotes.clear();
+	releasingStops = false;
+
+	if (!reader.read(nextOrderId) || !reader.read(nextTradeId) || !reader.read(lastTradePrice) || !reader.read(tradedVolume)) return false;
+
+	uint8_t traded;
+	if (!reader.read(traded) || traded > 1) return false;
+	hasLastTrade = traded != 0;
+
+	if (!reader.read(firedStops)) return false;
+
+	//Queues come best level first and front to back, so appending rebuilds them as they were
+	size_t count;
+	if (!reader.readCount(count, sizeof(Order))) return false;
+	for (size_t i = 0; i < count; i++) {
+		Order order;
+		if (!reader.read(order)) return false;
+
+		PriceLevel& level = (order.side == Side::BUY) ? bids.get(order.price) : asks.get(order.price);
+		orderPool.pushBack(level, orderPool.allocate(order));
+	}
 
-	Trader* buyer = traders[bidOrder.traderId];
-	Trader* seller = traders[askOrder.traderId];
+	if (!reader.readCount(count, sizeof(Order) + sizeof(StopTerms))) return false;
+	for (size_t i = 0; i < count; i++) {
+		Order stop;
+		StopTerms terms;
+		if (!reader.read(stop) || !reader.read(terms)) return false;
+		if (terms.kind != StopKind::Market && terms.kind != StopKind::Limit) return false;
 
-	double cashExchanged = price * volume;
+		uint32_t slot = stopPool.allocate(stop);
+		if (slot >= stopTerms.size()) stopTerms.resize(stopPool.capacity());
+		stopTerms[slot] = terms;
 
-	if (buyer) {
-		buyer->changeFunds(-cashExchanged);
-		buyer->changeStocks(volume);
+		if (stop.side == Side::BUY) stopPool.pushBack(buyStops.get(stop.price), slot);
+		else stopPool.pushBack(sellStops.get(stop.price), slot);
 	}
 
-	if (seller) {
-		seller->changeFunds(cashExchanged);
-		seller->changeStocks(-volume);
+	if (!reader.readCount(count, sizeof(TraderId) + sizeof(QuoteIds))) return false;
+	for (size_t i = 0; i < count; i++) {
+		TraderId traderId;
+		QuoteIds quote;
+		if (!reader.read(traderId) || !reader.read(quote)) return false;
+		quotes[traderId] = quote;
 	}
+
+	return tradeRecords.loadState(reader) && midPriceRecords.loadState(reader) && indicators.loadState(reader);
+}
+
+template<Side S>
+void LimitOrderBook::rest(const Order& order)
+{
+	PriceLevel& priceLevel = levels<S>().get(order.price);
+	orderPool.pushBack(priceLevel, orderPool.allocate(order));
+	if (!listeners.empty()) publishLevel(S, priceLevel, priceLevel.orderCount == 1 ? LevelChange::Added : LevelChange::Changed);
+}
+
+void LimitOrderBook::addLimitOrder(Order incomingOrder)
+{
+	if (incomingOrder.side == Side::BUY) rest<BUY>(incomingOrder);
+	else rest<SELL>(incomingOrder);
+
+	if (marketData) marketData->writeOrderAdded(incomingOrder);
+}
+
+void LimitOrderBook::recordTrade(const Order& bidOrder, const Order& askOrder, Volume volume, Ticks price, Clock& clock)
+{
+	TradeRecord tradeRecord = {};
+	tradeRecord.buyerId = bidOrder.traderId;
+	tradeRecord.sellerId = askOrder.traderId;
+	tradeRecord.timeStamp = static_cast<TimeStamp>(clock.now());
+	tradeRecord.tradeId = nextTradeId++;
+	tradeRecord.price = price;
+	tradeRecord.volume = volume;
+	tradeRecords.push(tradeRecord.timeStamp, tradeRecord);
+	tradedVolume += volume;
+
+	if (journal) journal->writeTrade(tradeRecord);
+	if (marketData) marketData->writeTrade(tradeRecord);
+	for (BookListener* listener : listeners) listener->onTrade(tradeRecord);
+
+	if (registry) registry->settle(tradeRecord, symbol);
 }
 
 const std::vector<DepthPoint> LimitOrderBook::depthChartPoints(float binSize, long* totalVolume) const
@@ -306,11 +735,8 @@ const std::vector<DepthPoint> LimitOrderBook::depthChartPoints(float binSize, lo
 
 	//Adding points in reverse then reversing to avoid adding to front
 	for (auto it = bids.begin(); it != bids.end(); ++it) {
-		long levelVol = 0;
-		for (const auto& order : it->second) levelVol += order.volume;
-
-		runningBidVol += levelVol;
-		float priceLevel = std::floor(it->first / binSize) * binSize;
+		runningBidVol += it->totalVolume;
+		float priceLevel = std::floor(static_cast<float>(toPrice(it->price)) / binSize) * binSize;
 
 		tempBids.push_back({ priceLevel, runningBidVol });
 	}
@@ -320,16 +746,14 @@ const std::vector<DepthPoint> LimitOrderBook::depthChartPoints(float binSize, lo
 	}
 
 	//Midpoint
-	float midPrice = (bids.begin()->first + asks.begin()->first) / 2.0f;
+	float midPrice = static_cast<float>(toPrice(bids.bestPrice() + asks.bestPrice()) / 2.0);
 	depthPoints.push_back({ std::floor(midPrice / binSize) * binSize, 0 });
 
 	long runningAskVol = 0;
 	for (auto it = asks.begin(); it != asks.end(); ++it) {
-		long levelVol = 0;
-		for (const auto& order : it->second) levelVol += order.volume;
-		runningAskVol += levelVol;
+		runningAskVol += it->totalVolume;
 
-		float priceLevel = std::floor(it->first / binSize) * binSize;
+		float priceLevel = std::floor(static_cast<float>(toPrice(it->price)) / binSize) * binSize;
 		depthPoints.push_back({ priceLevel, runningAskVol });
 	}
 
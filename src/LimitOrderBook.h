@@ -7,49 +7,161 @@
 
 #include "datatypes.h"
 #include "Clock.h"
-#include "Trader.h"
+#include "TraderRegistry.h"
+#include "PriceMap.h"
+#include "PriceLadder.h"
+#include "BookSide.h"
+#include "OrderPool.h"
+#include "Journal.h"
+#include "MarketData.h"
+#include "MarketIndicators.h"
+#include "HistoryStore.h"
+#include "BookListener.h"
+#include "Checkpoint.h"
 
-namespace sf {
-    class RenderWindow;
-    class Font;
-}
+//MARKETSIM_MAP_BOOK switches back to std::map levels, e.g. to benchmark against the ladder
+#ifdef MARKETSIM_MAP_BOOK
+template<Side S> using BookLevels = PriceMap<S>;
+#else
+template<Side S> using BookLevels = PriceLadder<S>;
+#endif
+
+//A trader's two-sided quote, 0 where that side isn't resting
+struct QuoteIds
+{
+	OrderId bidId = 0;
+	OrderId askId = 0;
+};
+
+//What a waiting stop goes in as once triggered
+struct StopTerms
+{
+	Ticks limitPrice;
+	StopKind kind;
+};
 
 class LimitOrderBook
 {
 private:
-	std::map<double, std::list<Order>, std::greater<double>> bids;
-	std::map<double, std::list<Order>> asks;
-	std::unordered_map<long, Trader*> traders;
+	SymbolId symbol;
+
+	BookLevels<BUY> bids;
+	BookLevels<SELL> asks;
+	TraderRegistry* registry = nullptr;
+
+	OrderPool orderPool;
+
+	OrderId nextOrderId = 1;
+
+	Ticks lastTradePrice = 0;
+	bool hasLastTrade = false; //lastTradePrice only means something once a trade has printed
+	TradeHistory tradeRecords;
+	MidPriceHistory midPriceRecords;
+	MarketIndicators indicators;
+
+	uint32_t nextTradeId = 1;
+	long tradedVolume = 0;
+	uint64_t firedStops[2] = {}; //By side
 
-	std::unordered_map<long, std::list<Order>::iterator> orderLookup;
+	JournalWriter* journal = nullptr;
+	MarketDataWriter* marketData = nullptr;
+	std::vector<BookListener*> listeners;
 
-	long nextOrderId = 1;
+	std::unordered_map<TraderId, QuoteIds> quotes;
 
-	double lastTradePrice = 0.0;
-	std::vector<TradeRecord> tradeRecords;
-	std::vector<double> midPriceRecords;
+	//Stops waiting for their trigger, as FIFO nodes under levels keyed by trigger price (the
+	//node's order.price) so the nearest trigger is always first. Limit prices sit beside the
+	//pool, indexed by slot, with whether they go in as market or limit orders.
+	OrderPool stopPool{ 256 };
+	PriceMap<SELL> buyStops; //Lowest trigger first, they fire on trades at or above it
+	PriceMap<BUY> sellStops; //Highest trigger first, they fire on trades at or below it
+	std::vector<StopTerms> stopTerms;
+	bool releasingStops = false;
 
-	long nextTradeId = 1;
+	//Per-side work, instantiated once for each side so the loops inside carry no side tests.
+	//The public entry points pick the side once and hand over.
+	template<Side S> BookLevels<S>& levels();
+	template<Side S> const BookLevels<S>& levels() const;
+	template<Side S> bool crosses(Ticks limitPrice) const;
+	template<Side S> void match(Order& incomingOrder, Clock& clock);
+	template<Side S> void rest(const Order& order);
+	template<Side S> void unlink(uint32_t slot);
+
+	bool crosses(const Order& order) const;
+	void route(Order& order, Clock& clock);
+	void removeOrder(uint32_t slot);
+	CommandResult applyCommand(const Command& command, Clock& clock);
+
+	void publishLevel(Side side, const PriceLevel& level, LevelChange change);
+
+	void releaseStops(Clock& clock);
+	bool cancelStop(OrderId orderId);
 public:
+	explicit LimitOrderBook(SymbolId symbol = 0);
 
-	const std::map<double, std::list<Order>, std::greater<double>>& getBids() const;
-	const std::map<double, std::list<Order>>& getAsks() const;
-	const Trader* getTrader(long id) const;
+	SymbolId getSymbol() const;
+	const BookLevels<BUY>& getBids() const;
+	const BookLevels<SELL>& getAsks() const;
 	long getHighestVolume(Side side, size_t priceLevels) const;
 
-	void update();
+	//Per-level aggregates, kept current by addLimitOrder/executeMatch/cancelOrder
+	long getVolumeAt(Side side, Ticks price) const;
+	std::vector<LevelInfo> getTopLevels(Side side, size_t count) const;
+	size_t getTopLevels(Side side, LevelInfo* out, size_t count) const; //Fills out best first, returns how many it wrote
+	long getCumulativeDepth(Side side, Ticks limitPrice) const; //Resting volume at limitPrice or better
 
-	const std::vector<TradeRecord>& getTradeHistory() const;
-	const std::vector<double>& getMidPriceHistory() const;
+	void update(const Clock& clock);
 
-	long processOrder(const Order& incomingOrder, Clock& clock);
-	void executeMatch(Order& incomingOrder, Clock& clock);
+	const TradeHistory& getTradeHistory() const;
+	const MidPriceHistory& getMidPriceHistory() const;
+	const MarketIndicators& getIndicators() const;
+	void setIndicatorWindows(const IndicatorWindows& windows); //Restarts the indicators
+	size_t getOrderCount() const;
+	size_t getStopCount() const; //Stops still waiting for their trigger
+	size_t getFiredStopCount(Side side) const; //Stops that have triggered so far
+	size_t getTradeCount() const;
+	long getTradedVolume() const;
+
+	OrderId processOrder(const Order& incomingOrder, Clock& clock);
+	void executeMatch(Order& incomingOrder, Clock& clock, bool restRemainder = true);
 	void addLimitOrder(Order incomingOrder);
-	bool cancelOrder(long orderId);
+	bool cancelOrder(OrderId orderId); //Resting orders and waiting stops
+
+	//Holds the order until a trade prints at or through triggerPrice (at or above for a buy,
+	//at or below for a sell), then sends it in under the id returned here. Stops are checked
+	//once the order that traded is done, and every stop released that way can trigger more,
+	//in trigger order (the earlier stop first when both sides fire).
+	OrderId placeStop(const Order& order, Ticks triggerPrice, StopKind kind, Clock& clock);
+
+	//Applies commands in order, with the same outcome as one call per command, and writes
+	//results[i] for commands[i]. Orders that can't trade skip the matcher, and a run of them
+	//on the same level shares one level lookup and one listener delta.
+	void processBatch(const Command* commands, size_t count, CommandResult* results, Clock& clock);
+
+	//Keeps the order's place in the queue when the price stays and the volume doesn't grow.
+	//Any other change re-enters it (and may trade) under the same id. newVolume <= 0 cancels.
+	bool amendOrder(OrderId orderId, Ticks newPrice, Volume newVolume, Clock& clock);
+
+	//Replaces the trader's bid and ask in one call, amending whichever side is still resting.
+	//A side with zero volume is left out. A side that would cross the trader's own resting
+	//quote pulls that quote first, so a quote never trades with itself (an inverted quote
+	//keeps only its ask).
+	QuoteIds massQuote(TraderId traderId, const Order& bid, const Order& ask, Clock& clock);
+
+	void setTraderRegistry(TraderRegistry* registry); //Accounts settled on every trade, none by default
+	void setJournal(JournalWriter* journal);
+	void setMarketDataWriter(MarketDataWriter* writer); //Streams trades, mid samples and book events out while running
+	void addListener(BookListener* listener); //Hears every trade and level delta, in the order they happen
+	void removeListener(BookListener* listener);
+	void setHistoryRetention(size_t trades, size_t midPrices); //Rows to keep at least, HistoryUnlimited for all
 
-	void registerTrader(Trader* trader);
+	//Everything the book holds: resting orders in queue order, stops, quotes, id counters,
+	//histories and indicators. Loading replaces all of it and keeps the attached registry,
+	//journal, writers and listeners, which hear nothing about the restored orders.
+	void saveState(CheckpointWriter& writer) const;
+	bool loadState(CheckpointReader& reader);
 
-	void recordTrade(const Order& restingOrder, const Order& incomingOrder, long volume, double price, Clock& clock);
+	void recordTrade(const Order& restingOrder, const Order& incomingOrder, Volume volume, Ticks price, Clock& clock);
 
 	const std::vector<DepthPoint> depthChartPoints(float binSize, long* totalVolume) const;
 };
\ No newline at end of file
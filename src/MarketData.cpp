@@ -0,0 +1,390 @@
+#include <cstring>
+#include <chrono>
+#include <fstream>
+
+#include "MarketData.h"
+
+static constexpr char MarketDataMagic[4] = { 'M', 'S', 'M', 'D' };
+static constexpr uint32_t MarketDataVersion = 1;
+static constexpr size_t BlockRows = 4096;
+static constexpr auto FlushInterval = std::chrono::milliseconds(100);
+
+static constexpr size_t TradeRowBytes = 6 * 4;
+static constexpr size_t MidRowBytes = 4 + 8;
+static constexpr size_t EventRowBytes = 5 * 4 + 2;
+
+template<class T>
+static void storeColumn(unsigned char* column, size_t row, T value)
+{
+	std::memcpy(column + row * sizeof(T), &value, sizeof(T));
+}
+
+template<class T>
+static T loadColumn(const unsigned char* column, size_t row)
+{
+	T value;
+	std::memcpy(&value, column + row * sizeof(T), sizeof(T));
+	return value;
+}
+
+static size_t rowBytes(MarketDataStream stream)
+{
+	switch (stream)
+	{
+	case MarketDataStream::Trades: return TradeRowBytes;
+	case MarketDataStream::MidPrices: return MidRowBytes;
+	case MarketDataStream::BookEvents: return EventRowBytes;
+	}
+	return 0;
+}
+
+MarketDataWriter::MarketDataWriter(size_t queueCapacity)
+	: queue(queueCapacity)
+{}
+
+MarketDataWriter::~MarketDataWriter()
+{
+	close();
+}
+
+bool MarketDataWriter::open(const std::string& path)
+{
+	close();
+
+	file = std::fopen(path.c_str(), "wb");
+	if (!file) return false;
+
+	MarketDataHeader header = {};
+	std::memcpy(header.magic, MarketDataMagic, sizeof(header.magic));
+	header.version = MarketDataVersion;
+	header.blockRows = BlockRows;
+	std::fwrite(&header, sizeof(header), 1, file);
+
+	pendingTrades.reserve(BlockRows);
+	pendingMids.reserve(BlockRows);
+	pendingEvents.reserve(BlockRows);
+	scratch.reserve(sizeof(MarketDataBlockHeader) + BlockRows * TradeRowBytes);
+
+	stopping.store(false, std::memory_order_relaxed);
+	worker = std::thread(&MarketDataWriter::workerLoop, this);
+
+	return true;
+}
+
+void MarketDataWriter::close()
+{
+	if (!file) return;
+
+	stopping.store(true, std::memory_order_release);
+	worker.join();
+
+	std::fclose(file);
+	file = nullptr;
+}
+
+void MarketDataWriter::push(const Message& message)
+{
+	if (!file) return;
+	if (!queue.tryPush(message)) dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MarketDataWriter::writeTrade(const TradeRecord& trade)
+{
+	Message message;
+	message.stream = MarketDataStream::Trades;
+	message.trade = trade;
+	lastTime = trade.timeStamp;
+	push(message);
+}
+
+void MarketDataWriter::writeMidPrice(TimeStamp time, double price)
+{
+	Message message;
+	message.stream = MarketDataStream::MidPrices;
+	message.mid = { time, price };
+	lastTime = time;
+	push(message);
+}
+
+void MarketDataWriter::writeOrderAdded(const Order& order)
+{
+	Message message;
+	message.stream = MarketDataStream::BookEvents;
+	message.event = { order.timeStamp, order.id, order.traderId, order.price, order.volume, order.side, BookEventType::Added };
+	lastTime = order.timeStamp;
+	push(message);
+}
+
+void MarketDataWriter::writeOrderCancelled(const Order& order)
+{
+	Message message;
+	message.stream = MarketDataStream::BookEvents;
+	message.event = { lastTime, order.id, order.traderId, order.price, order.volume, order.side, BookEventType::Cancelled };
+	push(message);
+}
+
+void MarketDataWriter::writeOrderAmended(const Order& order, TimeStamp time)
+{
+	Message message;
+	message.stream = MarketDataStream::BookEvents;
+	message.event = { time, order.id, order.traderId, order.price, order.volume, order.side, BookEventType::Amended };
+	lastTime = time;
+	push(message);
+}
+
+size_t MarketDataWriter::getDropped() const
+{
+	return dropped.load(std::memory_order_relaxed);
+}
+
+void MarketDataWriter::workerLoop()
+{
+	auto lastFlush = std::chrono::steady_clock::now();
+	Message message;
+
+	while (true)
+	{
+		//Read the flag first so nothing pushed before close() is missed
+		bool finishing = stopping.load(std::memory_order_acquire);
+
+		bool any = false;
+		while (queue.tryPop(message))
+		{
+			any = true;
+			switch (message.stream)
+			{
+			case MarketDataStream::Trades:
+				pendingTrades.push_back(message.trade);
+				if (pendingTrades.size() == BlockRows) flushTrades();
+				break;
+			case MarketDataStream::MidPrices:
+				pendingMids.push_back(message.mid);
+				if (pendingMids.size() == BlockRows) flushMids();
+				break;
+			case MarketDataStream::BookEvents:
+				pendingEvents.push_back(message.event);
+				if (pendingEvents.size() == BlockRows) flushEvents();
+				break;
+			}
+		}
+
+		if (finishing) break;
+
+		auto now = std::chrono::steady_clock::now();
+		if (now - lastFlush >= FlushInterval) {
+			flushAll();
+			lastFlush = now;
+		}
+
+		if (!any) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	flushAll();
+}
+
+void MarketDataWriter::flushTrades()
+{
+	size_t rows = pendingTrades.size();
+	if (rows == 0) return;
+
+	MarketDataBlockHeader header = { static_cast<uint32_t>(MarketDataStream::Trades), static_cast<uint32_t>(rows) };
+	scratch.resize(sizeof(header) + rows * TradeRowBytes);
+	std::memcpy(scratch.data(), &header, sizeof(header));
+
+	unsigned char* columns = scratch.data() + sizeof(header);
+	for (size_t i = 0; i < rows; i++) {
+		const TradeRecord& trade = pendingTrades[i];
+		storeColumn(columns, i, trade.timeStamp);
+		storeColumn(columns + rows * 4, i, trade.tradeId);
+		storeColumn(columns + rows * 8, i, trade.price);
+		storeColumn(columns + rows * 12, i, trade.volume);
+		storeColumn(columns + rows * 16, i, trade.buyerId);
+		storeColumn(columns + rows * 20, i, trade.sellerId);
+	}
+
+	std::fwrite(scratch.data(), scratch.size(), 1, file);
+	pendingTrades.clear();
+}
+
+void MarketDataWriter::flushMids()
+{
+	size_t rows = pendingMids.size();
+	if (rows == 0) return;
+
+	MarketDataBlockHeader header = { static_cast<uint32_t>(MarketDataStream::MidPrices), static_cast<uint32_t>(rows) };
+	scratch.resize(sizeof(header) + rows * MidRowBytes);
+	std::memcpy(scratch.data(), &header, sizeof(header));
+
+	unsigned char* columns = scratch.data() + sizeof(header);
+	for (size_t i = 0; i < rows; i++) {
+		storeColumn(columns, i, pendingMids[i].time);
+		storeColumn(columns + rows * 4, i, pendingMids[i].price);
+	}
+
+	std::fwrite(scratch.data(), scratch.size(), 1, file);
+	pendingMids.clear();
+}
+
+void MarketDataWriter::flushEvents()
+{
+	size_t rows = pendingEvents.size();
+	if (rows == 0) return;
+
+	MarketDataBlockHeader header = { static_cast<uint32_t>(MarketDataStream::BookEvents), static_cast<uint32_t>(rows) };
+	scratch.resize(sizeof(header) + rows * EventRowBytes);
+	std::memcpy(scratch.data(), &header, sizeof(header));
+
+	unsigned char* columns = scratch.data() + sizeof(header);
+	for (size_t i = 0; i < rows; i++) {
+		const BookEvent& event = pendingEvents[i];
+		storeColumn(columns, i, event.time);
+		storeColumn(columns + rows * 4, i, event.orderId);
+		storeColumn(columns + rows * 8, i, event.traderId);
+		storeColumn(columns + rows * 12, i, event.price);
+		storeColumn(columns + rows * 16, i, event.volume);
+		storeColumn(columns + rows * 20, i, static_cast<uint8_t>(event.side));
+		storeColumn(columns + rows * 21, i, static_cast<uint8_t>(event.type));
+	}
+
+	std::fwrite(scratch.data(), scratch.size(), 1, file);
+	pendingEvents.clear();
+}
+
+void MarketDataWriter::flushAll()
+{
+	flushTrades();
+	flushMids();
+	flushEvents();
+	std::fflush(file);
+}
+
+TimeStamp MarketDataBlock::time(size_t row) const
+{
+	return loadColumn<TimeStamp>(columns, row);
+}
+
+TradeRecord MarketDataBlock::trade(size_t row) const
+{
+	TradeRecord trade = {};
+	trade.timeStamp = loadColumn<TimeStamp>(columns, row);
+	trade.tradeId = loadColumn<uint32_t>(columns + rows * 4, row);
+	trade.price = loadColumn<Ticks>(columns + rows * 8, row);
+	trade.volume = loadColumn<Volume>(columns + rows * 12, row);
+	trade.buyerId = loadColumn<TraderId>(columns + rows * 16, row);
+	trade.sellerId = loadColumn<TraderId>(columns + rows * 20, row);
+	return trade;
+}
+
+double MarketDataBlock::midPrice(size_t row) const
+{
+	return loadColumn<double>(columns + rows * 4, row);
+}
+
+BookEvent MarketDataBlock::bookEvent(size_t row) const
+{
+	BookEvent event = {};
+	event.time = loadColumn<TimeStamp>(columns, row);
+	event.orderId = loadColumn<OrderId>(columns + rows * 4, row);
+	event.traderId = loadColumn<TraderId>(columns + rows * 8, row);
+	event.price = loadColumn<Ticks>(columns + rows * 12, row);
+	event.volume = loadColumn<Volume>(columns + rows * 16, row);
+	event.side = static_cast<Side>(loadColumn<uint8_t>(columns + rows * 20, row));
+	event.type = static_cast<BookEventType>(loadColumn<uint8_t>(columns + rows * 21, row));
+	return event;
+}
+
+bool MarketDataReader::open(const std::string& path)
+{
+	blocks.clear();
+	if (!mapped.open(path) || mapped.getSize() < sizeof(MarketDataHeader)) return false;
+
+	MarketDataHeader header;
+	std::memcpy(&header, mapped.getData(), sizeof(header));
+	if (std::memcmp(header.magic, MarketDataMagic, sizeof(MarketDataMagic)) != 0 || header.version != MarketDataVersion) return false;
+
+	size_t offset = sizeof(MarketDataHeader);
+	while (offset + sizeof(MarketDataBlockHeader) <= mapped.getSize())
+	{
+		MarketDataBlockHeader blockHeader;
+		std::memcpy(&blockHeader, mapped.getData() + offset, sizeof(blockHeader));
+
+		MarketDataStream stream = static_cast<MarketDataStream>(blockHeader.stream);
+		size_t bytes = blockHeader.rows * rowBytes(stream);
+		if (bytes == 0 && blockHeader.rows > 0) break; //Unknown stream, nothing after it can be trusted
+		if (offset + sizeof(blockHeader) + bytes > mapped.getSize()) break; //Still being written
+
+		blocks.push_back({ stream, blockHeader.rows, mapped.getData() + offset + sizeof(blockHeader) });
+		offset += sizeof(blockHeader) + bytes;
+	}
+
+	return true;
+}
+
+const std::vector<MarketDataBlock>& MarketDataReader::getBlocks() const
+{
+	return blocks;
+}
+
+size_t MarketDataReader::getRowCount(MarketDataStream stream) const
+{
+	size_t rows = 0;
+	for (const MarketDataBlock& block : blocks) {
+		if (block.stream == stream) rows += block.rows;
+	}
+	return rows;
+}
+
+static const char* bookEventName(BookEventType type)
+{
+	switch (type)
+	{
+	case BookEventType::Added: return "add";
+	case BookEventType::Cancelled: return "cancel";
+	case BookEventType::Amended: return "amend";
+	}
+	return "unknown";
+}
+
+bool convertMarketDataToCsv(const std::string& path, const std::string& prefix)
+{
+	MarketDataReader reader;
+	if (!reader.open(path)) return false;
+
+	std::ofstream trades(prefix + "_trades.csv");
+	std::ofstream mids(prefix + "_mids.csv");
+	std::ofstream book(prefix + "_book.csv");
+	if (!trades || !mids || !book) return false;
+
+	trades << "time,tradeId,price,volume,buyerId,sellerId\n";
+	mids << "time,mid\n";
+	book << "time,event,orderId,traderId,side,price,volume\n";
+
+	for (const MarketDataBlock& block : reader.getBlocks())
+	{
+		for (size_t i = 0; i < block.rows; i++)
+		{
+			switch (block.stream)
+			{
+			case MarketDataStream::Trades:
+			{
+				TradeRecord trade = block.trade(i);
+				trades << trade.timeStamp << ',' << trade.tradeId << ',' << toPrice(trade.price) << ',' << trade.volume << ','
+					<< trade.buyerId << ',' << trade.sellerId << '\n';
+				break;
+			}
+			case MarketDataStream::MidPrices:
+				mids << block.time(i) << ',' << block.midPrice(i) << '\n';
+				break;
+			case MarketDataStream::BookEvents:
+			{
+				BookEvent event = block.bookEvent(i);
+				book << event.time << ',' << bookEventName(event.type) << ',' << event.orderId << ','
+					<< event.traderId << ',' << (event.side == BUY ? "buy" : "sell") << ',' << toPrice(event.price) << ',' << event.volume << '\n';
+				break;
+			}
+			}
+		}
+	}
+
+	return true;
+}
\ No newline at end of file
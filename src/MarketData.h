@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#include "datatypes.h"
+#include "SpscQueue.h"
+#include "MappedFile.h"
+
+enum class BookEventType : uint8_t
+{
+	Added = 1, //Order came to rest, volume is what rested
+	Cancelled = 2, //volume is what was still resting
+	Amended = 3 //Volume cut in place. An amend that loses priority shows as Cancelled then Added.
+};
+
+struct BookEvent
+{
+	TimeStamp time;
+	OrderId orderId;
+	TraderId traderId;
+	Ticks price;
+	Volume volume;
+	Side side;
+	BookEventType type;
+};
+
+enum class MarketDataStream : uint32_t
+{
+	Trades = 1,
+	MidPrices = 2,
+	BookEvents = 3
+};
+
+struct MarketDataHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t blockRows;
+	uint32_t reserved;
+};
+
+//Every block is this header followed by its columns, each `rows` values long:
+//  Trades:     time, tradeId, price, volume, buyerId, sellerId (4 bytes each)
+//  MidPrices:  time (4 bytes), price (double)
+//  BookEvents: time, orderId, traderId, price, volume (4 bytes each), side, type (1 byte each)
+struct MarketDataBlockHeader
+{
+	uint32_t stream;
+	uint32_t rows;
+};
+
+//Streams trades, mid price samples and book events to a columnar file from a
+//background thread. The engine side only pushes into a lock-free queue and never
+//waits: if the writer falls that far behind, records are dropped and counted.
+//Blocks are written as they fill, partial ones at least every FlushInterval, so
+//the file can be read while the run is still going.
+class MarketDataWriter
+{
+private:
+	struct MidSample
+	{
+		TimeStamp time;
+		double price;
+	};
+
+	struct Message
+	{
+		MarketDataStream stream;
+		union
+		{
+			TradeRecord trade;
+			MidSample mid;
+			BookEvent event;
+		};
+	};
+
+	SpscQueue<Message> queue;
+	std::atomic<size_t> dropped{ 0 };
+	TimeStamp lastTime = 0; //Producer side, for cancels that carry no time
+
+	std::thread worker;
+	std::atomic<bool> stopping{ false };
+	std::FILE* file = nullptr;
+
+	//Writer thread only
+	std::vector<TradeRecord> pendingTrades;
+	std::vector<MidSample> pendingMids;
+	std::vector<BookEvent> pendingEvents;
+	std::vector<unsigned char> scratch;
+
+	void push(const Message& message);
+	void workerLoop();
+	void flushTrades();
+	void flushMids();
+	void flushEvents();
+	void flushAll();
+public:
+	explicit MarketDataWriter(size_t queueCapacity = 1 << 18);
+	~MarketDataWriter();
+
+	MarketDataWriter(const MarketDataWriter&) = delete;
+	MarketDataWriter& operator=(const MarketDataWriter&) = delete;
+
+	bool open(const std::string& path);
+	void close(); //Drains the queue, writes what is left and joins the writer
+	bool isOpen() const { return file != nullptr; }
+
+	//Engine side, one thread only
+	void writeTrade(const TradeRecord& trade);
+	void writeMidPrice(TimeStamp time, double price);
+	void writeOrderAdded(const Order& order);
+	void writeOrderCancelled(const Order& order);
+	void writeOrderAmended(const Order& order, TimeStamp time);
+
+	size_t getDropped() const;
+};
+
+struct MarketDataBlock
+{
+	MarketDataStream stream;
+	uint32_t rows;
+	const unsigned char* columns;
+
+	TimeStamp time(size_t row) const;
+	TradeRecord trade(size_t row) const;
+	double midPrice(size_t row) const;
+	BookEvent bookEvent(size_t row) const;
+};
+
+//Maps an export file and indexes its blocks. A block the writer hasn't finished yet is left out.
+class MarketDataReader
+{
+private:
+	MappedFile mapped;
+	std::vector<MarketDataBlock> blocks;
+public:
+	bool open(const std::string& path);
+
+	const std::vector<MarketDataBlock>& getBlocks() const;
+	size_t getRowCount(MarketDataStream stream) const;
+};
+
+//Writes <prefix>_trades.csv, <prefix>_mids.csv and <prefix>_book.csv
+bool convertMarketDataToCsv(const std::string& path, const std::string& prefix);
\ No newline at end of file
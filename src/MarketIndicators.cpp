@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <cmath>
+
+#include "MarketIndicators.h"
+#include "datatypes.h"
+
+static constexpr double HALF_TICK = TICK_SIZE / 2.0;
+
+MarketIndicators::MarketIndicators(const IndicatorWindows& windows)
+{
+	reset(windows);
+}
+
+void MarketIndicators::reset(const IndicatorWindows& windows)
+{
+	this->windows = windows;
+	this->windows.sma = std::max<size_t>(1, windows.sma);
+	this->windows.ema = std::max<size_t>(1, windows.ema);
+	this->windows.variance = std::max<size_t>(1, windows.variance);
+
+	size_t longest = std::max({ this->windows.sma, this->windows.variance, this->windows.momentum + 1 });
+	ring.assign(longest, 0);
+	next = 0;
+	count = 0;
+
+	smaSum = 0;
+	varSum = 0;
+	varSumSq = 0;
+	last = 0.0;
+	ema = 0.0;
+}
+
+void MarketIndicators::saveState(CheckpointWriter& writer) const
+{
+	writer.write(windows);
+	writer.writeVector(ring);
+	writer.write<uint64_t>(next);
+	writer.write<uint64_t>(count);
+	writer.write(smaSum);
+	writer.write(varSum);
+	writer.write(varSumSq);
+	writer.write(last);
+	writer.write(ema);
+}
+
+bool MarketIndicators::loadState(CheckpointReader& reader)
+{
+	IndicatorWindows savedWindows;
+	uint64_t savedNext;
+	uint64_t savedCount;
+	if (!reader.read(savedWindows)) return false;
+
+	reset(savedWindows);
+	size_t ringSize = ring.size();
+
+	if (!reader.readVector(ring) || ring.size() != ringSize || !reader.read(savedNext) || !reader.read(savedCount)
+		|| savedNext >= ringSize || !reader.read(smaSum) || !reader.read(varSum) || !reader.read(varSumSq)
+		|| !reader.read(last) || !reader.read(ema)) {
+		reset(savedWindows);
+		return false;
+	}
+
+	next = static_cast<size_t>(savedNext);
+	count = static_cast<size_t>(savedCount);
+	return true;
+}
+
+long long MarketIndicators::sampleAgo(size_t back) const
+{
+	return ring[(next + ring.size() - 1 - back) % ring.size()];
+}
+
+void MarketIndicators::push(double midPrice)
+{
+	long long value = std::llround(midPrice / HALF_TICK);
+
+	//Drop what falls out of each window before the ring slot gets overwritten
+	if (count >= windows.sma) smaSum -= sampleAgo(windows.sma - 1);
+	if (count >= windows.variance) {
+		long long old = sampleAgo(windows.variance - 1);
+		varSum -= old;
+		varSumSq -= old * old;
+	}
+
+	ring[next] = value;
+	next = (next + 1) % ring.size();
+	count++;
+
+	smaSum += value;
+	varSum += value;
+	varSumSq += value * value;
+	last = midPrice;
+
+	double alpha = 2.0 / (windows.ema + 1.0);
+	ema = count == 1 ? midPrice : ema + alpha * (midPrice - ema);
+}
+
+const IndicatorWindows& MarketIndicators::getWindows() const
+{
+	return windows;
+}
+
+size_t MarketIndicators::getSampleCount() const
+{
+	return count;
+}
+
+double MarketIndicators::getLast() const
+{
+	return last;
+}
+
+double MarketIndicators::getSma() const
+{
+	size_t n = std::min(count, windows.sma);
+	return n == 0 ? 0.0 : static_cast<double>(smaSum) / n * HALF_TICK;
+}
+
+double MarketIndicators::getEma() const
+{
+	return ema;
+}
+
+double MarketIndicators::getVariance() const
+{
+	size_t n = std::min(count, windows.variance);
+	if (n == 0) return 0.0;
+
+	double mean = static_cast<double>(varSum) / n;
+	double variance = static_cast<double>(varSumSq) / n - mean * mean;
+	return std::max(0.0, variance) * HALF_TICK * HALF_TICK;
+}
+
+double MarketIndicators::getStdDev() const
+{
+	return std::sqrt(getVariance());
+}
+
+double MarketIndicators::getMomentum() const
+{
+	if (count == 0) return 0.0;
+
+	size_t back = std::min(windows.momentum, count - 1);
+	return (sampleAgo(0) - sampleAgo(back)) * HALF_TICK;
+}
\ No newline at end of file
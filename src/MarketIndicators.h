@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include "Checkpoint.h"
+
+struct IndicatorWindows
+{
+	size_t sma = 100; //Samples, one per LimitOrderBook::update
+	size_t ema = 100; //Period, smoothing factor 2 / (period + 1)
+	size_t variance = 100;
+	size_t momentum = 10; //Last mid minus the mid this many samples earlier
+};
+
+//Rolling indicators over the mid price, fed once per tick by LimitOrderBook::update so
+//strategies read them in O(1) instead of each walking the history. Sums are kept in
+//integer half ticks (every mid is a multiple of one), so they never drift.
+//Until a window has filled, its indicator covers every sample so far.
+class MarketIndicators
+{
+private:
+	IndicatorWindows windows;
+
+	std::vector<long long> ring; //Last samples in half ticks, sized for the longest window
+	size_t next = 0;
+	size_t count = 0;
+
+	long long smaSum = 0;
+	long long varSum = 0;
+	long long varSumSq = 0;
+	double last = 0.0;
+	double ema = 0.0;
+
+	long long sampleAgo(size_t back) const; //back = 0 is the newest sample
+public:
+	explicit MarketIndicators(const IndicatorWindows& windows = {});
+
+	void push(double midPrice);
+	void reset(const IndicatorWindows& windows);
+
+	void saveState(CheckpointWriter& writer) const;
+	bool loadState(CheckpointReader& reader);
+
+	const IndicatorWindows& getWindows() const;
+	size_t getSampleCount() const;
+
+	double getLast() const;
+	double getSma() const;
+	double getEma() const;
+	double getVariance() const; //Population variance of the window
+	double getStdDev() const;
+	double getMomentum() const;
+};
\ No newline at end of file
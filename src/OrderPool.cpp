@@ -0,0 +1,124 @@
+#include "OrderPool.h"
+
+OrderPool::OrderPool(size_t capacity)
+{
+	size_t rounded = 1;
+	while (rounded < capacity) rounded <<= 1;
+
+	grow(rounded);
+}
+
+void OrderPool::grow(size_t capacity)
+{
+	size_t oldSize = nodes.size();
+	nodes.resize(capacity);
+
+	//Push new slots so the lowest index is handed out first
+	for (size_t i = capacity; i-- > oldSize;) {
+		nodes[i].order.id = 0;
+		nodes[i].next = freeHead;
+		freeHead = static_cast<uint32_t>(i);
+	}
+
+	//Rebuild the ring at the new size, which also folds the overflow back in
+	idSlots.assign(capacity, NilSlot);
+	idMask = static_cast<OrderId>(capacity - 1);
+	overflow.clear();
+
+	for (uint32_t slot = 0; slot < oldSize; slot++) {
+		if (nodes[slot].order.id != 0) mapId(nodes[slot].order.id, slot);
+	}
+}
+
+void OrderPool::mapId(OrderId id, uint32_t slot)
+{
+	uint32_t& entry = idSlots[id & idMask];
+
+	if (entry != NilSlot) {
+		OrderId resident = nodes[entry].order.id;
+		if (resident != 0 && resident != id && (resident & idMask) == (id & idMask)) {
+			overflow.emplace(resident, entry);
+		}
+	}
+
+	entry = slot;
+}
+
+uint32_t OrderPool::allocate(const Order& order)
+{
+	if (freeHead == NilSlot) grow(nodes.size() * 2);
+
+	uint32_t slot = freeHead;
+	OrderNode& node = nodes[slot];
+	freeHead = node.next;
+
+	node.order = order;
+	node.prev = NilSlot;
+	node.next = NilSlot;
+
+	mapId(order.id, slot);
+	liveCount++;
+
+	return slot;
+}
+
+void OrderPool::release(uint32_t slot)
+{
+	OrderNode& node = nodes[slot];
+	uint32_t& entry = idSlots[node.order.id & idMask];
+
+	if (entry == slot) {
+		entry = NilSlot;
+	}
+	else if (!overflow.empty()) {
+		overflow.erase(node.order.id);
+	}
+
+	node.order.id = 0;
+	node.next = freeHead;
+	freeHead = slot;
+	liveCount--;
+}
+
+uint32_t OrderPool::find(OrderId id) const
+{
+	if (id == 0) return NilSlot;
+
+	uint32_t slot = idSlots[id & idMask];
+	if (slot != NilSlot && nodes[slot].order.id == id) return slot;
+
+	if (!overflow.empty()) {
+		auto it = overflow.find(id);
+		if (it != overflow.end()) return it->second;
+	}
+
+	return NilSlot;
+}
+
+void OrderPool::pushBack(PriceLevel& level, uint32_t slot)
+{
+	OrderNode& node = nodes[slot];
+	node.prev = level.tail;
+	node.next = NilSlot;
+
+	if (level.tail != NilSlot) nodes[level.tail].next = slot;
+	else level.head = slot;
+
+	level.tail = slot;
+	level.orderCount++;
+	level.totalVolume += node.order.volume;
+}
+
+void OrderPool::unlink(PriceLevel& level, uint32_t slot)
+{
+	OrderNode& node = nodes[slot];
+
+	if (node.prev != NilSlot) nodes[node.prev].next = node.next;
+	else level.head = node.next;
+
+	if (node.next != NilSlot) nodes[node.next].prev = node.prev;
+	else level.tail = node.prev;
+
+	level.orderCount--;
+	level.totalVolume -= node.order.volume;
+}
\ No newline at end of file
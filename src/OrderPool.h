@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+#include "datatypes.h"
+
+struct OrderNode
+{
+	Order order;
+	uint32_t prev;
+	uint32_t next;
+};
+
+//Preallocated resting orders, linked into their price level as intrusive FIFO nodes.
+//Order ids map to slots through a ring indexed by the low bits of the id; the id stored
+//in the node acts as the generation, so a stale ring entry never resolves to a reused slot.
+//Live orders that outlast a full trip around the ring spill into a small overflow map.
+class OrderPool
+{
+private:
+	std::vector<OrderNode> nodes;
+	uint32_t freeHead = NilSlot;
+	size_t liveCount = 0;
+
+	std::vector<uint32_t> idSlots;
+	OrderId idMask = 0;
+	std::unordered_map<OrderId, uint32_t> overflow;
+
+	void grow(size_t capacity);
+	void mapId(OrderId id, uint32_t slot);
+public:
+	explicit OrderPool(size_t capacity = 4096);
+
+	uint32_t allocate(const Order& order);
+	void release(uint32_t slot);
+	uint32_t find(OrderId id) const;
+
+	void pushBack(PriceLevel& level, uint32_t slot);
+	void unlink(PriceLevel& level, uint32_t slot);
+
+	OrderNode& operator[](uint32_t slot) { return nodes[slot]; }
+	const OrderNode& operator[](uint32_t slot) const { return nodes[slot]; }
+
+	size_t size() const { return liveCount; }
+	size_t capacity() const { return nodes.size(); }
+};
\ No newline at end of file
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "datatypes.h"
+#include "BookSide.h"
+#include "PriceMap.h"
+
+//Contiguous price levels indexed by tick offset from base.
+//The window re-centers (and grows if it has to) when an order lands outside it,
+//and the occupied range [lo, hi] doubles as the best-price cursor.
+//The window never grows past MaxLevels: a price that would stretch it further goes to a
+//sparse map of outliers instead, so one order far from the book can't allocate the gap.
+template<Side S>
+class PriceLadder
+{
+private:
+	static constexpr size_t InitialLevels = 1024;
+	static constexpr size_t MaxLevels = size_t(1) << 18;
+
+	std::vector<PriceLevel> levels;
+	std::vector<PriceLevel> spare; //Reused on re-center so shifting the window doesn't allocate
+	PriceMap<S> outliers; //Levels outside the window, never overlapping it
+
+	Ticks base = 0; //Price of levels[0]
+	size_t levelCount = 0; //Non-empty levels in the window
+	ptrdiff_t lo = 0;
+	ptrdiff_t hi = -1;
+
+	static constexpr ptrdiff_t step = BookSide<S>::step;
+
+	ptrdiff_t bestIdx() const { return (S == BUY) ? hi : lo; }
+	ptrdiff_t worstIdx() const { return (S == BUY) ? lo : hi; }
+
+	bool inWindow(Ticks price) const
+	{
+		int64_t offset = static_cast<int64_t>(price) - base;
+		return offset >= 0 && offset < static_cast<int64_t>(levels.size());
+	}
+
+	//Whether the window can take price and still stay within MaxLevels
+	bool fits(Ticks price) const
+	{
+		if (levelCount == 0) return true;
+
+		int64_t newLo = std::min<int64_t>(price, base + lo);
+		int64_t newHi = std::max<int64_t>(price, base + hi);
+		return static_cast<size_t>(newHi - newLo) + 1 <= MaxLevels / 2;
+	}
+
+	void occupy(ptrdiff_t idx)
+	{
+		if (levelCount == 0) {
+			lo = idx;
+			hi = idx;
+		}
+		else {
+			lo = std::min(lo, idx);
+			hi = std::max(hi, idx);
+		}
+		levelCount++;
+	}
+
+	void recenter(Ticks price)
+	{
+		size_t newSize = std::max(levels.size(), InitialLevels);
+		int64_t newLo = price;
+		int64_t newHi = price;
+
+		if (levelCount > 0) {
+			newLo = std::min<int64_t>(newLo, base + lo);
+			newHi = std::max<int64_t>(newHi, base + hi);
+		}
+
+		//Keep at least half the window free so a drifting price doesn't re-center every tick
+		size_t span = static_cast<size_t>(newHi - newLo) + 1;
+		while (newSize < span * 2) newSize *= 2;
+
+		//Clamped so base + newSize stays a valid price
+		int64_t newBase = newLo + (newHi - newLo) / 2 - static_cast<int64_t>(newSize / 2);
+		newBase = std::max<int64_t>(newBase, std::numeric_limits<Ticks>::lowest());
+		newBase = std::min<int64_t>(newBase, static_cast<int64_t>(std::numeric_limits<Ticks>::max()) - static_cast<int64_t>(newSize) + 1);
+
+		spare.resize(newSize);
+		for (size_t i = 0; i < newSize; i++) {
+			spare[i] = PriceLevel{ static_cast<Ticks>(newBase + static_cast<int64_t>(i)) };
+		}
+
+		if (levelCount > 0) {
+			ptrdiff_t shift = static_cast<ptrdiff_t>(base - newBase);
+			for (ptrdiff_t i = lo; i <= hi; i++) {
+				PriceLevel& moved = spare[i + shift];
+				moved = levels[i];
+				moved.price = static_cast<Ticks>(newBase + i + shift);
+			}
+			lo += shift;
+			hi += shift;
+		}
+
+		levels.swap(spare);
+		base = static_cast<Ticks>(newBase);
+
+		//Outliers the new window now covers move into it
+		if (outliers.empty()) return;
+
+		std::vector<Ticks> covered;
+		for (const PriceLevel& level : outliers) {
+			if (inWindow(level.price)) covered.push_back(level.price);
+		}
+
+		for (Ticks coveredPrice : covered) {
+			ptrdiff_t idx = coveredPrice - base;
+			levels[idx] = *outliers.find(coveredPrice);
+			occupy(idx);
+			outliers.erase(coveredPrice);
+		}
+	}
+public:
+	//Walks the window and the outliers together, best price first
+	class const_iterator
+	{
+	private:
+		using OutlierIterator = typename PriceMap<S>::const_iterator;
+
+		const PriceLadder* ladder;
+		ptrdiff_t idx;
+		ptrdiff_t endIdx;
+		OutlierIterator outlier;
+		OutlierIterator outlierEnd;
+		bool onOutlier = false; //Whether the outlier cursor holds the better of the two
+
+		void pick()
+		{
+			onOutlier = outlier != outlierEnd
+				&& (idx == endIdx || typename BookSide<S>::Compare{}(outlier->price, ladder->levels[idx].price));
+		}
+	public:
+		const_iterator(const PriceLadder* ladder, ptrdiff_t idx, ptrdiff_t endIdx, OutlierIterator outlier)
+			: ladder(ladder), idx(idx), endIdx(endIdx), outlier(outlier), outlierEnd(ladder->outliers.end())
+		{
+			pick();
+		}
+
+		const PriceLevel& operator*() const { return onOutlier ? *outlier : ladder->levels[idx]; }
+		const PriceLevel* operator->() const { return &**this; }
+
+		const_iterator& operator++()
+		{
+			if (onOutlier) {
+				++outlier;
+			}
+			else {
+				do {
+					idx += step;
+				} while (idx != endIdx && ladder->levels[idx].empty());
+			}
+
+			pick(); //Also drops back to the window once the last outlier is passed
+			return *this;
+		}
+
+		bool operator==(const const_iterator& other) const { return idx == other.idx && outlier == other.outlier; }
+		bool operator!=(const const_iterator& other) const { return !(*this == other); }
+	};
+
+	const_iterator begin() const
+	{
+		if (levelCount == 0) return const_iterator(this, -1, -1, outliers.begin());
+		return const_iterator(this, bestIdx(), worstIdx() + step, outliers.begin());
+	}
+
+	const_iterator end() const
+	{
+		ptrdiff_t endIdx = (levelCount == 0) ? -1 : worstIdx() + step;
+		return const_iterator(this, endIdx, endIdx, outliers.end());
+	}
+
+	bool empty() const { return levelCount == 0 && outliers.empty(); }
+	size_t size() const { return levelCount + outliers.size(); }
+
+	PriceLevel& best()
+	{
+		if (outliers.empty()) return levels[bestIdx()];
+		if (levelCount == 0 || BookSide<S>::atOrBetter(outliers.bestPrice(), bestPrice())) return outliers.best();
+		return levels[bestIdx()];
+	}
+
+	const PriceLevel& best() const { return const_cast<PriceLadder*>(this)->best(); }
+
+	Ticks bestPrice() const
+	{
+		Ticks windowBest = base + static_cast<Ticks>(bestIdx());
+		if (outliers.empty()) return windowBest;
+		if (levelCount == 0 || BookSide<S>::atOrBetter(outliers.bestPrice(), windowBest)) return outliers.bestPrice();
+		return windowBest;
+	}
+
+	PriceLevel* find(Ticks price)
+	{
+		if (!inWindow(price)) return outliers.find(price);
+
+		PriceLevel& level = levels[price - base];
+		return level.empty() ? nullptr : &level;
+	}
+
+	const PriceLevel* find(Ticks price) const
+	{
+		return const_cast<PriceLadder*>(this)->find(price);
+	}
+
+	//Returns the level at price, the caller is expected to add an order to it
+	PriceLevel& get(Ticks price)
+	{
+		if (!inWindow(price)) {
+			if (!fits(price)) return outliers.get(price);
+			recenter(price);
+		}
+
+		ptrdiff_t idx = price - base;
+		PriceLevel& level = levels[idx];
+
+		if (level.empty()) occupy(idx);
+
+		return level;
+	}
+
+	//Releases a level whose last order the caller has just removed
+	void erase(Ticks price)
+	{
+		if (!inWindow(price)) {
+			outliers.erase(price);
+			return;
+		}
+
+		ptrdiff_t idx = price - base;
+		if (idx < lo || idx > hi) return;
+
+		levelCount--;
+
+		if (levelCount == 0) {
+			lo = 0;
+			hi = -1;
+			return;
+		}
+
+		while (levels[lo].empty()) lo++;
+		while (levels[hi].empty()) hi--;
+	}
+};
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <map>
+
+#include "datatypes.h"
+#include "BookSide.h"
+
+//Price levels kept in a std::map, ordered best price first
+template<Side S>
+class PriceMap
+{
+private:
+	using LevelMap = std::map<Ticks, PriceLevel, typename BookSide<S>::Compare>;
+
+	LevelMap levels;
+public:
+	class const_iterator
+	{
+	private:
+		typename LevelMap::const_iterator it;
+	public:
+		explicit const_iterator(typename LevelMap::const_iterator it) : it(it) {}
+
+		const PriceLevel& operator*() const { return it->second; }
+		const PriceLevel* operator->() const { return &it->second; }
+		const_iterator& operator++() { ++it; return *this; }
+		bool operator==(const const_iterator& other) const { return it == other.it; }
+		bool operator!=(const const_iterator& other) const { return it != other.it; }
+	};
+
+	const_iterator begin() const { return const_iterator(levels.begin()); }
+	const_iterator end() const { return const_iterator(levels.end()); }
+
+	bool empty() const { return levels.empty(); }
+	size_t size() const { return levels.size(); }
+
+	PriceLevel& best() { return levels.begin()->second; }
+	const PriceLevel& best() const { return levels.begin()->second; }
+	Ticks bestPrice() const { return levels.begin()->first; }
+
+	PriceLevel* find(Ticks price)
+	{
+		auto it = levels.find(price);
+		return it != levels.end() ? &it->second : nullptr;
+	}
+
+	const PriceLevel* find(Ticks price) const
+	{
+		auto it = levels.find(price);
+		return it != levels.end() ? &it->second : nullptr;
+	}
+
+	//Returns the level at price, creating an empty one if needed
+	PriceLevel& get(Ticks price)
+	{
+		auto it = levels.find(price);
+		if (it == levels.end()) {
+			it = levels.emplace(price, PriceLevel{ price }).first;
+		}
+		return it->second;
+	}
+
+	void erase(Ticks price)
+	{
+		levels.erase(price);
+	}
+};
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include <fstream>
+#include <algorithm>
+#include <iomanip>
+
+#include "Profiler.h"
+
+size_t LatencyHistogram::bucketFor(uint64_t ticks)
+{
+	if (ticks < SubBuckets) return static_cast<size_t>(ticks);
+
+	unsigned msb = 0;
+	for (unsigned step = 32; step > 0; step >>= 1) {
+		if (ticks >> (msb + step)) msb += step;
+	}
+
+	unsigned exponent = msb - SubBucketBits + 1;
+	if (exponent > MaxExponent) return BucketCount - 1;
+
+	//The top bit is implied by the exponent, the next SubBucketBits pick the bucket
+	return exponent * SubBuckets + ((ticks >> (exponent - 1)) & (SubBuckets - 1));
+}
+
+uint64_t LatencyHistogram::bucketMidpoint(size_t bucket)
+{
+	if (bucket < SubBuckets) return bucket;
+
+	unsigned exponent = static_cast<unsigned>(bucket / SubBuckets);
+	uint64_t lower = (SubBuckets + bucket % SubBuckets) << (exponent - 1);
+	return lower + ((uint64_t(1) << (exponent - 1)) >> 1);
+}
+
+void LatencyHistogram::record(uint64_t ticks)
+{
+	buckets[bucketFor(ticks)].fetch_add(1, std::memory_order_relaxed);
+	total.fetch_add(ticks, std::memory_order_relaxed);
+
+	uint64_t seen = max.load(std::memory_order_relaxed);
+	while (ticks > seen && !max.compare_exchange_weak(seen, ticks, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::reset()
+{
+	for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+	total.store(0, std::memory_order_relaxed);
+	max.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::getCount() const
+{
+	uint64_t calls = 0;
+	for (const auto& bucket : buckets) calls += bucket.load(std::memory_order_relaxed);
+	return calls;
+}
+
+uint64_t LatencyHistogram::getMax() const
+{
+	return max.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::getMean() const
+{
+	uint64_t calls = getCount();
+	return calls == 0 ? 0.0 : static_cast<double>(total.load(std::memory_order_relaxed)) / calls;
+}
+
+uint64_t LatencyHistogram::percentile(double q) const
+{
+	//Counted from the buckets themselves so a record landing mid-read can't push past the end
+	uint64_t snapshot[BucketCount];
+	uint64_t calls = 0;
+	for (size_t i = 0; i < BucketCount; i++) {
+		snapshot[i] = buckets[i].load(std::memory_order_relaxed);
+		calls += snapshot[i];
+	}
+	if (calls == 0) return 0;
+
+	uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(calls - 1)) + 1;
+	if (rank >= calls) return getMax();
+	uint64_t seen = 0;
+	for (size_t i = 0; i < BucketCount; i++) {
+		seen += snapshot[i];
+		if (seen >= rank) return std::min(bucketMidpoint(i), getMax());
+	}
+	return getMax();
+}
+
+static LatencyHistogram histograms[static_cast<size_t>(Probe::Count)];
+
+//Where both clocks stood at startup, the baseline for nanosecondsPerTick
+static const uint64_t startTicks = Profiler::now();
+static const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+double Profiler::nanosecondsPerTick()
+{
+#ifdef MARKETSIM_HAS_RDTSC
+	uint64_t ticks = now() - startTicks;
+	double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startTime).count();
+	return ticks == 0 ? 1.0 : nanoseconds / static_cast<double>(ticks);
+#else
+	return 1.0;
+#endif
+}
+
+LatencyHistogram& Profiler::histogram(Probe probe)
+{
+	return histograms[static_cast<size_t>(probe)];
+}
+
+const char* Profiler::probeName(Probe probe)
+{
+	switch (probe)
+	{
+	case Probe::ProcessOrder: return "processOrder";
+	case Probe::ExecuteMatch: return "executeMatch";
+	case Probe::CancelOrder: return "cancelOrder";
+	case Probe::BookUpdate: return "LOB update";
+	case Probe::RandomDecide: return "random decide";
+	case Probe::TrendDecide: return "trend decide";
+	case Probe::DepthChartUpdate: return "depth chart";
+	case Probe::LOBPanelDraw: return "LOB panel draw";
+	case Probe::Count: break;
+	}
+	return "?";
+}
+
+void Profiler::reset()
+{
+	for (auto& histogram : histograms) histogram.reset();
+}
+
+bool Profiler::writeReport(const std::string& path)
+{
+	std::ofstream out(path);
+	if (!out) return false;
+
+	double toMicroseconds = nanosecondsPerTick() / 1000.0;
+
+	out << std::fixed << std::setprecision(3);
+	out << std::left << std::setw(16) << "probe" << std::right << std::setw(12) << "calls"
+		<< std::setw(11) << "mean us" << std::setw(11) << "p50 us" << std::setw(11) << "p90 us"
+		<< std::setw(11) << "p99 us" << std::setw(11) << "p99.9 us" << std::setw(11) << "max us" << "\n";
+
+	for (size_t i = 0; i < static_cast<size_t>(Probe::Count); i++) {
+		Probe probe = static_cast<Probe>(i);
+		const LatencyHistogram& h = histogram(probe);
+
+		out << std::left << std::setw(16) << probeName(probe) << std::right << std::setw(12) << h.getCount()
+			<< std::setw(11) << h.getMean() * toMicroseconds
+			<< std::setw(11) << h.percentile(0.5) * toMicroseconds
+			<< std::setw(11) << h.percentile(0.9) * toMicroseconds
+			<< std::setw(11) << h.percentile(0.99) * toMicroseconds
+			<< std::setw(11) << h.percentile(0.999) * toMicroseconds
+			<< std::setw(11) << h.getMax() * toMicroseconds << "\n";
+	}
+
+	return static_cast<bool>(out);
+}
\ No newline at end of file
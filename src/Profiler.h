@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define MARKETSIM_HAS_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define MARKETSIM_HAS_RDTSC
+#endif
+
+//Hot paths with a latency histogram. Timers only exist in builds with MARKETSIM_PROFILE,
+//elsewhere the histograms stay empty.
+enum class Probe : uint8_t
+{
+	ProcessOrder, //Including passive orders that take the processBatch shortcut
+	ExecuteMatch,
+	CancelOrder,
+	BookUpdate,
+	RandomDecide,
+	TrendDecide,
+	DepthChartUpdate, //Rebuilds only
+	LOBPanelDraw,
+	Count
+};
+
+//Log-linear histogram of latencies in Profiler::now() ticks in the style of HdrHistogram:
+//exact below 32, then 32 buckets per power of two (about 3% resolution) up to 2^43 ticks. Any
+//thread may record at the same time as any thread reads.
+class LatencyHistogram
+{
+public:
+	static constexpr unsigned SubBucketBits = 5;
+	static constexpr unsigned SubBuckets = 1u << SubBucketBits;
+	static constexpr unsigned MaxExponent = 38; //Longer calls land in the last bucket
+	static constexpr size_t BucketCount = SubBuckets * (MaxExponent + 1);
+private:
+	std::atomic<uint64_t> buckets[BucketCount] = {};
+	std::atomic<uint64_t> total{ 0 };
+	std::atomic<uint64_t> max{ 0 };
+
+	static size_t bucketFor(uint64_t nanoseconds);
+	static uint64_t bucketMidpoint(size_t bucket);
+public:
+	void record(uint64_t ticks);
+	void reset();
+
+	uint64_t getCount() const; //Sums the buckets, meant for reports rather than hot paths
+	uint64_t getMax() const;
+	double getMean() const;
+	uint64_t percentile(double q) const; //q in [0, 1], 0 when empty
+};
+
+class Profiler
+{
+public:
+#ifdef MARKETSIM_PROFILE
+	static constexpr bool enabled = true;
+#else
+	static constexpr bool enabled = false;
+#endif
+
+	//The time stamp counter where there is one (a couple of times cheaper than steady_clock),
+	//steady_clock nanoseconds elsewhere
+	static uint64_t now()
+	{
+#ifdef MARKETSIM_HAS_RDTSC
+		return __rdtsc();
+#else
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+	}
+
+	//Measured against steady_clock since startup, so it settles as the program runs
+	static double nanosecondsPerTick();
+
+	static LatencyHistogram& histogram(Probe probe);
+	static const char* probeName(Probe probe);
+	static void reset();
+
+	//One line per probe with calls, mean and p50 to p99.9 in microseconds
+	static bool writeReport(const std::string& path);
+};
+
+class ScopedTimer
+{
+private:
+	LatencyHistogram& histogram;
+	uint64_t start;
+public:
+	explicit ScopedTimer(Probe probe)
+		: histogram(Profiler::histogram(probe)),
+		start(Profiler::now())
+	{}
+
+	~ScopedTimer()
+	{
+		histogram.record(Profiler::now() - start);
+	}
+
+	ScopedTimer(const ScopedTimer&) = delete;
+	ScopedTimer& operator=(const ScopedTimer&) = delete;
+};
+
+//Times the rest of the enclosing scope, compiles to nothing without MARKETSIM_PROFILE
+#ifdef MARKETSIM_PROFILE
+#define MARKETSIM_PROFILE_SCOPE(probe) ScopedTimer profileScope(probe)
+#else
+#define MARKETSIM_PROFILE_SCOPE(probe) ((void)0)
+#endif
\ No newline at end of file
@@ -0,0 +1,57 @@
+#include <cstdio>
+
+#include "ProfilerOverlay.h"
+#include "Profiler.h"
+#include "UIHelpers.h"
+
+void ProfilerOverlay::update(const sf::Font& font, float right, float top) {
+    batch.setFont(font);
+
+    auto now = std::chrono::steady_clock::now();
+    if (now < nextRefresh && right == builtRight) return;
+
+    nextRefresh = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(refreshInterval));
+    builtRight = right;
+    build(right, top);
+}
+
+void ProfilerOverlay::build(float right, float top) {
+    batch.clear();
+
+    constexpr size_t probeCount = static_cast<size_t>(Probe::Count);
+    float width = 900.f;
+    float padding = 10.f;
+    float height = padding * 2.f + RowHeight * (probeCount + 1);
+
+    batch.addRect(right, top, width, height, TextSnap::Right, 0.f, Theme::Surface);
+
+    float x = right - width + padding;
+    float y = top + padding;
+    char line[128];
+    double toMicroseconds = Profiler::nanosecondsPerTick() / 1000.0;
+
+    if (!Profiler::enabled) {
+        batch.addText("Profiling is off, build with -DMARKETSIM_PROFILE=ON", FontSize, x, y, TextSnap::Left, 0.f, Theme::TextDim);
+        return;
+    }
+
+    std::snprintf(line, sizeof(line), "%-15s %10s %8s %8s %8s %8s %8s %8s", "probe (us)", "calls", "mean", "p50", "p90", "p99", "p99.9", "max");
+    batch.addText(line, FontSize, x, y, TextSnap::Left, 0.f, Theme::Accent);
+
+    for (size_t i = 0; i < probeCount; i++) {
+        Probe probe = static_cast<Probe>(i);
+        const LatencyHistogram& h = Profiler::histogram(probe);
+        uint64_t calls = h.getCount();
+        y += RowHeight;
+
+        std::snprintf(line, sizeof(line), "%-15s %10llu %8.2f %8.2f %8.2f %8.2f %8.2f %8.2f", Profiler::probeName(probe),
+            static_cast<unsigned long long>(calls), h.getMean() * toMicroseconds,
+            h.percentile(0.5) * toMicroseconds, h.percentile(0.9) * toMicroseconds, h.percentile(0.99) * toMicroseconds,
+            h.percentile(0.999) * toMicroseconds, h.getMax() * toMicroseconds);
+        batch.addText(line, FontSize, x, y, TextSnap::Left, 0.f, calls > 0 ? Theme::TextMain : Theme::TextDim);
+    }
+}
+
+void ProfilerOverlay::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    target.draw(batch, states);
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <chrono>
+
+#include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/RenderStates.hpp>
+#include <SFML/Graphics/Font.hpp>
+
+#include "QuadBatch.h"
+
+//Table of the Profiler histograms (calls, mean, p50 to p99.9 and max per probe), read a few
+//times a second so the numbers stay legible and reading them costs next to nothing
+class ProfilerOverlay : public sf::Drawable {
+private:
+    static constexpr unsigned FontSize = 16;
+    static constexpr float RowHeight = 22.f;
+
+    QuadBatch batch;
+    std::chrono::steady_clock::time_point nextRefresh{};
+    float builtRight = 0.f;
+
+    void build(float right, float top);
+
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+public:
+    double refreshInterval = 0.25; //Seconds
+
+    void update(const sf::Font& font, float right, float top); //Anchored at its top right corner
+};
\ No newline at end of file
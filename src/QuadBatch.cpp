@@ -0,0 +1,139 @@
+#include <cmath>
+#include <algorithm>
+#include <SFML/Graphics/PrimitiveType.hpp>
+#include <SFML/Graphics/Glyph.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/System/Vector2.hpp>
+
+#include "QuadBatch.h"
+
+static float snapOffset(TextSnap snap, float width)
+{
+    switch (snap)
+    {
+    case TextSnap::Center:
+        return -width / 2.f;
+    case TextSnap::Right:
+        return -width;
+    default:
+        return 0.f;
+    }
+}
+
+static void appendQuad(sf::VertexArray& vertices, float left, float top, float right, float bottom, sf::Color color,
+    float u1 = 0.f, float v1 = 0.f, float u2 = 0.f, float v2 = 0.f)
+{
+    vertices.append({ { left, top }, color, { u1, v1 } });
+    vertices.append({ { right, top }, color, { u2, v1 } });
+    vertices.append({ { left, bottom }, color, { u1, v2 } });
+    vertices.append({ { left, bottom }, color, { u1, v2 } });
+    vertices.append({ { right, top }, color, { u2, v1 } });
+    vertices.append({ { right, bottom }, color, { u2, v2 } });
+}
+
+QuadBatch::QuadBatch() {
+    rects.setPrimitiveType(sf::PrimitiveType::Triangles);
+}
+
+void QuadBatch::setFont(const sf::Font& font) {
+    if (this->font == &font) return;
+
+    this->font = &font;
+    layers.clear();
+}
+
+void QuadBatch::clear() {
+    rects.clear();
+    for (TextLayer& layer : layers) layer.vertices.clear();
+}
+
+QuadBatch::TextLayer& QuadBatch::layerFor(unsigned characterSize) {
+    for (TextLayer& layer : layers) {
+        if (layer.characterSize == characterSize) return layer;
+    }
+
+    TextLayer& layer = layers.emplace_back();
+    layer.characterSize = characterSize;
+    layer.vertices.setPrimitiveType(sf::PrimitiveType::Triangles);
+
+    for (char c = FirstGlyph; c <= LastGlyph; c++) {
+        const sf::Glyph& glyph = font->getGlyph(static_cast<char32_t>(c), characterSize, false);
+        layer.glyphs[c - FirstGlyph] = { glyph.advance, glyph.bounds, glyph.textureRect };
+    }
+
+    return layer;
+}
+
+void QuadBatch::addRect(float x, float y, float width, float height, TextSnap snap, float offset, sf::Color color) {
+    float left = std::round(x + offset + snapOffset(snap, width));
+    float top = std::round(y);
+
+    appendQuad(rects, left, top, left + width, top + height, color);
+}
+
+void QuadBatch::addText(std::string_view text, unsigned characterSize, float x, float y, TextSnap snap, float offset, sf::Color color) {
+    if (!font || text.empty()) return;
+
+    TextLayer& layer = layerFor(characterSize);
+
+    auto glyphFor = [&](char c) -> const GlyphQuad& {
+        if (c < FirstGlyph || c > LastGlyph) c = '?';
+        return layer.glyphs[c - FirstGlyph];
+    };
+
+    //Same extent sf::Text::getLocalBounds reports, so snapping lines up with the old labels
+    float minX = static_cast<float>(characterSize);
+    float maxX = 0.f;
+    float penX = 0.f;
+    for (char c : text) {
+        const GlyphQuad& glyph = glyphFor(c);
+        if (c == ' ') {
+            minX = std::min(minX, penX);
+            penX += glyph.advance;
+            maxX = std::max(maxX, penX);
+            continue;
+        }
+
+        minX = std::min(minX, penX + glyph.bounds.position.x);
+        maxX = std::max(maxX, penX + glyph.bounds.position.x + glyph.bounds.size.x);
+        penX += glyph.advance;
+    }
+
+    float originX = std::round(x + offset + snapOffset(snap, maxX - minX));
+    float baseline = std::round(y) + static_cast<float>(characterSize);
+
+    //sf::Text pads every glyph quad by a pixel so filtering doesn't clip the edges
+    const float padding = 1.f;
+
+    penX = originX;
+    for (char c : text) {
+        const GlyphQuad& glyph = glyphFor(c);
+        if (c != ' ') {
+            float left = penX + glyph.bounds.position.x - padding;
+            float top = baseline + glyph.bounds.position.y - padding;
+            float right = penX + glyph.bounds.position.x + glyph.bounds.size.x + padding;
+            float bottom = baseline + glyph.bounds.position.y + glyph.bounds.size.y + padding;
+
+            float u1 = static_cast<float>(glyph.textureRect.position.x) - padding;
+            float v1 = static_cast<float>(glyph.textureRect.position.y) - padding;
+            float u2 = static_cast<float>(glyph.textureRect.position.x + glyph.textureRect.size.x) + padding;
+            float v2 = static_cast<float>(glyph.textureRect.position.y + glyph.textureRect.size.y) + padding;
+
+            appendQuad(layer.vertices, left, top, right, bottom, color, u1, v1, u2, v2);
+        }
+        penX += glyph.advance;
+    }
+}
+
+void QuadBatch::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    target.draw(rects, states);
+
+    if (!font) return;
+
+    for (const TextLayer& layer : layers) {
+        if (layer.vertices.getVertexCount() == 0) continue;
+
+        states.texture = &font->getTexture(layer.characterSize);
+        target.draw(layer.vertices, states);
+    }
+}
\ No newline at end of file
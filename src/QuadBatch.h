@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <string_view>
+
+#include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/RenderStates.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Rect.hpp>
+
+#include "UIHelpers.h"
+
+//Collects rectangles and text as quads and draws them in one call for the rectangles plus
+//one per character size (each size has its own glyph texture in the font). Glyph metrics are
+//cached per size, and clear() keeps the vertex buffers, so refilling doesn't allocate.
+//Text is laid out like sf::Text without kerning, the UI font is monospaced.
+class QuadBatch : public sf::Drawable {
+private:
+    static constexpr char FirstGlyph = ' ';
+    static constexpr char LastGlyph = '~';
+
+    struct GlyphQuad
+    {
+        float advance;
+        sf::FloatRect bounds;
+        sf::IntRect textureRect;
+    };
+
+    struct TextLayer
+    {
+        unsigned characterSize;
+        GlyphQuad glyphs[LastGlyph - FirstGlyph + 1];
+        sf::VertexArray vertices;
+    };
+
+    const sf::Font* font = nullptr;
+    sf::VertexArray rects;
+    std::vector<TextLayer> layers; //A handful of sizes, searched linearly
+
+    TextLayer& layerFor(unsigned characterSize);
+
+    virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+public:
+    QuadBatch();
+
+    void setFont(const sf::Font& font); //Drops the glyph cache when the font changes
+    void clear();
+
+    void addRect(float x, float y, float width, float height, TextSnap snap, float offset, sf::Color color);
+    void addText(std::string_view text, unsigned characterSize, float x, float y, TextSnap snap, float offset, sf::Color color);
+};
\ No newline at end of file
@@ -5,5 +5,5 @@
 class RandomStrategy : public TradeStrategy
 {
 public:
-	void decide(Trader& trader, LimitOrderBook& LOB, Clock& clock) override;
+	void decide(Trader& trader, const LimitOrderBook& LOB, const Clock& clock, std::vector<Command>& commands) override;
 };
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+//xoshiro256**, small enough for every trader to carry its own stream.
+//Satisfies UniformRandomBitGenerator so it plugs into the <random> distributions.
+class Rng
+{
+private:
+	uint64_t state[4];
+
+	static uint64_t splitMix(uint64_t& x)
+	{
+		uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	static uint64_t rotl(uint64_t x, int k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+public:
+	using result_type = uint64_t;
+
+	explicit Rng(uint64_t seed = 0, uint64_t stream = 0)
+	{
+		reseed(seed, stream);
+	}
+
+	//Same seed and stream always give the same sequence
+	void reseed(uint64_t seed, uint64_t stream)
+	{
+		uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+		for (auto& s : state) s = splitMix(x);
+	}
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+	result_type operator()()
+	{
+		uint64_t result = rotl(state[1] * 5, 7) * 9;
+		uint64_t t = state[1] << 17;
+
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= t;
+		state[3] = rotl(state[3], 45);
+
+		return result;
+	}
+};
\ No newline at end of file
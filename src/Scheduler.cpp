@@ -0,0 +1,102 @@
+#include <algorithm>
+
+#include "Scheduler.h"
+
+static bool later(const ScheduledEvent& a, const ScheduledEvent& b)
+{
+	return a.time > b.time;
+}
+
+static bool byOrder(const ScheduledEvent& a, const ScheduledEvent& b)
+{
+	return a.order < b.order;
+}
+
+Scheduler::Scheduler()
+	: wheel(WheelSize)
+{}
+
+void Scheduler::insert(const ScheduledEvent& event)
+{
+	std::vector<ScheduledEvent>& bucket = wheel[event.time & WheelMask];
+	if (bucket.capacity() == 0 && !spareBuckets.empty()) {
+		bucket.swap(spareBuckets.back());
+		spareBuckets.pop_back();
+	}
+
+	bucket.push_back(event);
+	wheelCount++;
+}
+
+void Scheduler::pullOverflow()
+{
+	while (!overflow.empty() && overflow.front().time < cursor + static_cast<long long>(WheelSize)) {
+		std::pop_heap(overflow.begin(), overflow.end(), later);
+		insert(overflow.back());
+		overflow.pop_back();
+	}
+}
+
+void Scheduler::schedule(long long time, uint64_t order, uint32_t target)
+{
+	if (time < cursor) time = cursor;
+
+	if (time < cursor + static_cast<long long>(WheelSize)) {
+		insert({ time, order, target });
+		return;
+	}
+
+	overflow.push_back({ time, order, target });
+	std::push_heap(overflow.begin(), overflow.end(), later);
+}
+
+long long Scheduler::nextTime()
+{
+	//Nothing close, jump straight to the next far event
+	if (wheelCount == 0) {
+		cursor = std::max(cursor, overflow.front().time);
+		pullOverflow();
+	}
+
+	while (wheel[cursor & WheelMask].empty()) {
+		cursor++;
+		pullOverflow();
+	}
+
+	return cursor;
+}
+
+void Scheduler::popNext(std::vector<ScheduledEvent>& out)
+{
+	std::vector<ScheduledEvent>& bucket = wheel[nextTime() & WheelMask];
+
+	//Buffers go back to the pool instead of staying with their bucket, so the next bucket
+	//to fill reuses one that is still in cache instead of one last touched a wheel turn ago
+	if (out.capacity() > 0) {
+		out.clear();
+		spareBuckets.emplace_back().swap(out);
+	}
+	out.swap(bucket);
+	wheelCount -= out.size();
+
+	if (!std::is_sorted(out.begin(), out.end(), byOrder)) std::sort(out.begin(), out.end(), byOrder);
+}
+
+void Scheduler::getPending(std::vector<ScheduledEvent>& out) const
+{
+	out.clear();
+	for (const auto& bucket : wheel) out.insert(out.end(), bucket.begin(), bucket.end());
+	out.insert(out.end(), overflow.begin(), overflow.end());
+}
+
+void Scheduler::clear()
+{
+	for (auto& bucket : wheel) {
+		if (bucket.capacity() == 0) continue;
+		bucket.clear();
+		spareBuckets.emplace_back().swap(bucket);
+	}
+	overflow.clear();
+	wheelCount = 0;
+	cursor = 0;
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+struct ScheduledEvent
+{
+	long long time;
+	uint64_t order; //Breaks ties between events at the same time, lower runs first
+	uint32_t target; //What to wake, up to the owner
+};
+
+//Timer wheel of pending events. The next WheelSize ticks each get a bucket, so scheduling
+//and taking a tick's events are O(1) apart from sorting a bucket that filled out of order.
+//Events further out wait in a heap and move into the wheel as it turns. Owners that need
+//a repeatable run keep (time, order) unique.
+class Scheduler
+{
+private:
+	static constexpr size_t WheelSize = 256;
+	static constexpr size_t WheelMask = WheelSize - 1;
+
+	std::vector<std::vector<ScheduledEvent>> wheel;
+	std::vector<std::vector<ScheduledEvent>> spareBuckets; //Emptied buffers, newest last so they are still in cache
+	std::vector<ScheduledEvent> overflow; //Min-heap of events at cursor + WheelSize or later
+	long long cursor = 0; //Every event in the wheel is in [cursor, cursor + WheelSize)
+	size_t wheelCount = 0;
+
+	void pullOverflow();
+	void insert(const ScheduledEvent& event);
+public:
+	Scheduler();
+
+	//Events in the past run at the earliest pending tick
+	void schedule(long long time, uint64_t order, uint32_t target);
+
+	bool empty() const { return wheelCount == 0 && overflow.empty(); }
+	size_t size() const { return wheelCount + overflow.size(); }
+
+	long long nextTime(); //Earliest pending time, only when not empty
+	void popNext(std::vector<ScheduledEvent>& out); //Replaces out with the events at nextTime(), by order
+	void getPending(std::vector<ScheduledEvent>& out) const; //Every event still to run, in no particular order
+	void clear(); //Drops every event and rewinds to time 0
+};
\ No newline at end of file
@@ -0,0 +1,358 @@
+#include <algorithm>
+#include <iterator>
+
+#include "Simulation.h"
+
+//Ranks of events sharing a tick, in the top byte of the scheduler order
+enum class EventRank : uint64_t
+{
+	SampleMid,
+	Scripted,
+	Arrival,
+	TraderWake
+};
+
+static uint64_t eventOrder(EventRank rank, uint64_t index)
+{
+	return (static_cast<uint64_t>(rank) << 56) | index;
+}
+
+Simulation::Simulation(const SimulationConfig& config)
+	: config(config),
+	whale(&randomStrat, registry, static_cast<TraderId>(config.trendTraders + config.randomTraders), 100000.0, 20000L)
+{
+	trendTraders.reserve(config.trendTraders);
+	for (size_t i = 0; i < config.trendTraders; i++) {
+		trendTraders.emplace_back(&trendStrat, registry, static_cast<TraderId>(i), 2000.0, 100L);
+	}
+
+	randomTraders.reserve(config.randomTraders);
+	for (size_t i = 0; i < config.randomTraders; i++) {
+		randomTraders.emplace_back(&randomStrat, registry, static_cast<TraderId>(i + config.trendTraders), 2000.0, 100L);
+	}
+
+	LOB.setTraderRegistry(&registry);
+	LOB.setHistoryRetention(config.tradeRetention, config.midPriceRetention);
+
+	for (auto& t : trendTraders) t.setWakeInterval(config.trendWakeInterval);
+	for (auto& t : randomTraders) t.setWakeInterval(config.randomWakeInterval);
+
+	for (auto& t : randomTraders) schedule.push_back(&t);
+	for (auto& t : trendTraders) schedule.push_back(&t);
+
+	for (Trader* t : schedule) t->seedRng(config.seed);
+	commandBuffers.resize(schedule.size());
+
+	if (config.parallelDecide) pool = std::make_unique<ThreadPool>(config.threads);
+
+	events.schedule(config.dt, eventOrder(EventRank::SampleMid, 0), 0);
+
+	onEveryStep.resize(schedule.size());
+	for (uint32_t i = 0; i < schedule.size(); i++) {
+		long long interval = schedule[i]->getWakeInterval();
+		onEveryStep[i] = interval <= 0;
+
+		if (onEveryStep[i]) everyStep.push_back(i);
+		else scheduleWake(i, config.dt + static_cast<long long>(i) % interval);
+	}
+
+	scheduleOrder(30, makeOrder(whale.getId(), Side::SELL, 10.0, 2000, 30));
+}
+
+void Simulation::scheduleWake(uint32_t traderIndex, long long time)
+{
+	events.schedule(time, eventOrder(EventRank::TraderWake, traderIndex), traderIndex);
+}
+
+void Simulation::scheduleOrder(long long time, const Order& order)
+{
+	uint32_t index = static_cast<uint32_t>(scriptedOrders.size());
+	scriptedOrders.push_back(order);
+	events.schedule(time, eventOrder(EventRank::Scripted, index), index);
+}
+
+void Simulation::sendCommands(Trader& trader, const std::vector<Command>& commands)
+{
+	if (config.orderLatency <= 0) {
+		applyCommands(trader, commands);
+		return;
+	}
+
+	if (commands.empty()) return;
+
+	uint32_t slot;
+	if (freeArrivals.empty()) {
+		slot = static_cast<uint32_t>(arrivals.size());
+		arrivals.emplace_back();
+	}
+	else {
+		slot = freeArrivals.back();
+		freeArrivals.pop_back();
+	}
+
+	arrivals[slot].trader = &trader;
+	arrivals[slot].commands.assign(commands.begin(), commands.end());
+	events.schedule(clock.now() + config.orderLatency, eventOrder(EventRank::Arrival, arrivalsSent++), slot);
+}
+
+void Simulation::applyCommands(Trader& trader, const std::vector<Command>& commands)
+{
+	batchResults.resize(commands.size());
+	LOB.processBatch(commands.data(), commands.size(), batchResults.data(), clock);
+
+	for (size_t i = 0; i < commands.size(); i++) {
+		bool placed = commands[i].type == CommandType::NewOrder || commands[i].type == CommandType::Stop;
+		if (placed && commands[i].trackActive) {
+			trader.addActiveOrderId(batchResults[i].orderId, LOB.getSymbol());
+		}
+	}
+}
+
+void Simulation::wakeTraders(const std::vector<uint32_t>& due)
+{
+	if (pool) {
+		pool->parallelFor(due.size(), [&](size_t i) {
+			uint32_t t = due[i];
+			commandBuffers[t].clear();
+			schedule[t]->update(LOB, clock, commandBuffers[t]);
+		});
+
+		for (uint32_t t : due) sendCommands(*schedule[t], commandBuffers[t]);
+	}
+	else {
+		for (uint32_t t : due) {
+			commandBuffers[t].clear();
+			schedule[t]->update(LOB, clock, commandBuffers[t]);
+			sendCommands(*schedule[t], commandBuffers[t]);
+		}
+	}
+
+	bool regroup = false;
+	for (uint32_t t : due) {
+		long long interval = schedule[t]->getWakeInterval();
+		bool everyStepNow = interval <= 0;
+
+		if (everyStepNow != static_cast<bool>(onEveryStep[t])) {
+			onEveryStep[t] = everyStepNow;
+			regroup = true;
+		}
+		if (!everyStepNow) scheduleWake(t, clock.now() + interval);
+	}
+
+	//due may be everyStep itself, so it is only rebuilt once the loops above are done
+	if (regroup) {
+		everyStep.clear();
+		for (uint32_t i = 0; i < schedule.size(); i++) {
+			if (onEveryStep[i]) everyStep.push_back(i);
+		}
+	}
+}
+
+void Simulation::runUntil(long long time)
+{
+	while (!events.empty() && events.nextTime() <= time)
+	{
+		clock.advanceTo(events.nextTime());
+		events.popNext(currentEvents);
+
+		bool stepped = false;
+
+		//Traders come last within a tick, so every one due is collected before any decides
+		for (const ScheduledEvent& event : currentEvents)
+		{
+			switch (static_cast<EventRank>(event.order >> 56))
+			{
+			case EventRank::SampleMid:
+				LOB.update(clock);
+				events.schedule(clock.now() + config.dt, event.order, 0);
+				stepped = true;
+				break;
+			case EventRank::Scripted:
+				LOB.processOrder(scriptedOrders[event.target], clock);
+				break;
+			case EventRank::Arrival:
+				applyCommands(*arrivals[event.target].trader, arrivals[event.target].commands);
+				freeArrivals.push_back(event.target);
+				break;
+			case EventRank::TraderWake:
+				woken.push_back(event.target);
+				break;
+			}
+		}
+
+		if (!stepped) {
+			if (!woken.empty()) wakeTraders(woken);
+		}
+		else if (woken.empty()) {
+			wakeTraders(everyStep);
+		}
+		else {
+			merged.clear();
+			std::merge(everyStep.begin(), everyStep.end(), woken.begin(), woken.end(), std::back_inserter(merged));
+			wakeTraders(merged);
+		}
+		woken.clear();
+	}
+
+	clock.advanceTo(time);
+}
+
+void Simulation::step()
+{
+	runUntil(clock.now() + config.dt);
+}
+
+void Simulation::setJournal(JournalWriter* journal)
+{
+	LOB.setJournal(journal);
+}
+
+void Simulation::setMarketDataWriter(MarketDataWriter* writer)
+{
+	LOB.setMarketDataWriter(writer);
+}
+
+void Simulation::addBookListener(BookListener* listener)
+{
+	LOB.addListener(listener);
+}
+
+Trader* Simulation::traderById(TraderId id)
+{
+	if (id < trendTraders.size()) return &trendTraders[id];
+	if (id - trendTraders.size() < randomTraders.size()) return &randomTraders[id - trendTraders.size()];
+	if (id == whale.getId()) return &whale;
+	return nullptr;
+}
+
+bool Simulation::saveCheckpoint(const std::string& path) const
+{
+	CheckpointWriter writer;
+	if (!writer.open(path)) return false;
+
+	writer.write<uint64_t>(trendTraders.size());
+	writer.write<uint64_t>(randomTraders.size());
+	writer.write(clock.now());
+
+	auto saveTrader = [&](const Trader& t) {
+		writer.write(t.getWakeInterval());
+		writer.write(t.getRng());
+	};
+
+	for (const auto& t : trendTraders) saveTrader(t);
+	for (const auto& t : randomTraders) saveTrader(t);
+	saveTrader(whale);
+
+	registry.saveState(writer);
+	LOB.saveState(writer);
+
+	std::vector<ScheduledEvent> pending;
+	events.getPending(pending);
+	writer.writeVector(pending);
+	writer.writeVector(scriptedOrders);
+
+	writer.write<uint64_t>(arrivals.size());
+	for (const Arrival& arrival : arrivals) {
+		writer.write(arrival.trader->getId());
+		writer.writeVector(arrival.commands);
+	}
+	writer.writeVector(freeArrivals);
+	writer.write(arrivalsSent);
+
+	return writer.close();
+}
+
+bool Simulation::loadCheckpoint(const std::string& path, std::string* error)
+{
+	auto fail = [&](const std::string& reason) {
+		if (error) *error = reason;
+		return false;
+	};
+	const char* damaged = "it is truncated or corrupt";
+
+	CheckpointReader reader;
+	if (!reader.open(path)) return fail("it can't be opened or isn't a checkpoint of this version");
+
+	uint64_t trendCount;
+	uint64_t randomCount;
+	long long time;
+	if (!reader.read(trendCount) || !reader.read(randomCount) || !reader.read(time)) return fail(damaged);
+
+	if (trendCount != trendTraders.size() || randomCount != randomTraders.size()) {
+		return fail("it has " + std::to_string(trendCount) + " trend and " + std::to_string(randomCount) + " random traders, this scenario has "
+			+ std::to_string(trendTraders.size()) + " and " + std::to_string(randomTraders.size()));
+	}
+
+	auto loadTrader = [&](Trader& t) {
+		long long interval;
+		if (!reader.read(interval) || !reader.read(t.getRng())) return false;
+		t.setWakeInterval(interval);
+		return true;
+	};
+
+	for (auto& t : trendTraders) if (!loadTrader(t)) return fail(damaged);
+	for (auto& t : randomTraders) if (!loadTrader(t)) return fail(damaged);
+	if (!loadTrader(whale)) return fail(damaged);
+
+	if (!registry.loadState(reader) || !LOB.loadState(reader)) return fail(damaged);
+
+	std::vector<ScheduledEvent> pending;
+	if (!reader.readVector(pending) || !reader.readVector(scriptedOrders)) return fail(damaged);
+
+	size_t arrivalCount;
+	if (!reader.readCount(arrivalCount, sizeof(TraderId) + sizeof(uint64_t))) return fail(damaged);
+	arrivals.assign(arrivalCount, {});
+	for (Arrival& arrival : arrivals) {
+		TraderId traderId;
+		if (!reader.read(traderId) || !reader.readVector(arrival.commands)) return fail(damaged);
+
+		arrival.trader = traderById(traderId);
+		if (!arrival.trader) return fail(damaged);
+	}
+	if (!reader.readVector(freeArrivals) || !reader.read(arrivalsSent)) return fail(damaged);
+
+	//Every event has to point at something that exists
+	for (const ScheduledEvent& event : pending) {
+		size_t limit = 1;
+		switch (static_cast<EventRank>(event.order >> 56))
+		{
+		case EventRank::SampleMid: break;
+		case EventRank::Scripted: limit = scriptedOrders.size(); break;
+		case EventRank::Arrival: limit = arrivals.size(); break;
+		case EventRank::TraderWake: limit = schedule.size(); break;
+		default: limit = 0; break;
+		}
+		if (event.target >= limit) return fail(damaged);
+	}
+
+	clock = Clock();
+	clock.advanceTo(time);
+
+	events.clear();
+	for (const ScheduledEvent& event : pending) events.schedule(event.time, event.order, event.target);
+
+	everyStep.clear();
+	for (uint32_t i = 0; i < schedule.size(); i++) {
+		onEveryStep[i] = schedule[i]->getWakeInterval() <= 0;
+		if (onEveryStep[i]) everyStep.push_back(i);
+	}
+	woken.clear();
+
+	if (!reader.ok() || !reader.atEnd()) return fail(damaged);
+	return true;
+}
+
+const LimitOrderBook& Simulation::getBook() const
+{
+	return LOB;
+}
+
+const Clock& Simulation::getClock() const
+{
+	return clock;
+}
+
+size_t Simulation::getTraderCount() const
+{
+	return trendTraders.size() + randomTraders.size() + 1;
+}
\ No newline at end of file
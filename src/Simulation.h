@@ -0,0 +1,122 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <string>
+
+#include "Clock.h"
+#include "LimitOrderBook.h"
+#include "Trader.h"
+#include "TraderRegistry.h"
+#include "TrendStrategy.h"
+#include "RandomStrategy.h"
+#include "ThreadPool.h"
+#include "Scheduler.h"
+
+struct SimulationConfig
+{
+	size_t trendTraders = 5;
+	size_t randomTraders = 10;
+	long long dt = 1; //Ticks per step, also how often the mid price is sampled
+
+	//Ticks between a trader's decisions, 0 for every step. Traders with a longer interval
+	//are spread over it so they don't all wake on the same tick.
+	long long trendWakeInterval = 0;
+	long long randomWakeInterval = 0;
+
+	long long orderLatency = 0; //Ticks between a trader deciding and its commands reaching the book
+
+	uint64_t seed = 1; //Every trader draws from its own stream derived from seed and its id
+
+	//Let every trader decide in parallel against the book as it stood at the start of the tick
+	bool parallelDecide = false;
+	size_t threads = 0; //0 uses every hardware thread
+
+	//Rows of trade and mid price history the book keeps at least, older chunks are dropped
+	size_t tradeRetention = HistoryUnlimited;
+	size_t midPriceRetention = HistoryUnlimited;
+};
+
+//The market scenario shared by the interactive app and the headless runner.
+//The book settles trades into the registry by address, so a Simulation is pinned in place.
+//
+//Event driven: mid price samples, scripted orders, delayed command arrivals and trader
+//wake-ups all sit in one scheduler, and the clock jumps from one event time to the next.
+//Events at the same tick run in that order: the mid sample, scripted orders, arrivals
+//(in the order they were sent), then the traders due (random traders, then trend traders,
+//each group in id order). Sequentially each trader's commands hit the book before the
+//next trader decides. With parallelDecide the traders due decide first and their commands
+//are applied afterwards in that same trader order, each trader's commands in the order
+//its strategy emitted them. Both modes repeat exactly for a given seed.
+class Simulation
+{
+private:
+	SimulationConfig config;
+
+	Clock clock;
+	LimitOrderBook LOB;
+	TraderRegistry registry;
+
+	TrendStrategy trendStrat;
+	RandomStrategy randomStrat;
+
+	std::vector<Trader> trendTraders;
+	std::vector<Trader> randomTraders;
+	Trader whale;
+
+	//Commands sent but still travelling to the book, slots reused through freeArrivals
+	struct Arrival
+	{
+		Trader* trader;
+		std::vector<Command> commands;
+	};
+
+	Scheduler events;
+	std::vector<ScheduledEvent> currentEvents;
+	std::vector<Order> scriptedOrders;
+	std::vector<Arrival> arrivals;
+	std::vector<uint32_t> freeArrivals;
+	uint64_t arrivalsSent = 0;
+
+	std::vector<Trader*> schedule;
+	//Schedule indices. Traders without a wake interval run on every step without going through
+	//the scheduler, the rest are woken by it.
+	std::vector<uint32_t> everyStep;
+	std::vector<uint8_t> onEveryStep;
+	std::vector<uint32_t> woken;
+	std::vector<uint32_t> merged;
+	std::vector<std::vector<Command>> commandBuffers;
+	std::vector<CommandResult> batchResults;
+	std::unique_ptr<ThreadPool> pool;
+
+	void scheduleWake(uint32_t traderIndex, long long time);
+	void wakeTraders(const std::vector<uint32_t>& due); //Schedule indices in schedule order
+	void sendCommands(Trader& trader, const std::vector<Command>& commands);
+	void applyCommands(Trader& trader, const std::vector<Command>& commands);
+	Trader* traderById(TraderId id);
+public:
+	explicit Simulation(const SimulationConfig& config = {});
+
+	Simulation(const Simulation&) = delete;
+	Simulation& operator=(const Simulation&) = delete;
+
+	void step(); //runUntil one dt ahead
+	void runUntil(long long time); //Runs every event up to and including time, then leaves the clock there
+	void scheduleOrder(long long time, const Order& order); //Sent to the book as is at time
+	void setJournal(JournalWriter* journal);
+	void setMarketDataWriter(MarketDataWriter* writer);
+	void addBookListener(BookListener* listener);
+
+	//The whole run as it stands: clock, book, accounts, every trader's random stream and wake
+	//interval, and the events still pending, so a restored run carries on exactly as the
+	//saved one would have. Loading needs the same number of traders; the rest of the config
+	//(dt, latency, decide mode) is this simulation's own. A load that fails partway leaves
+	//the simulation in a mixed state that should not be run; error gets the reason.
+	bool saveCheckpoint(const std::string& path) const;
+	bool loadCheckpoint(const std::string& path, std::string* error = nullptr);
+
+	const LimitOrderBook& getBook() const;
+	const Clock& getClock() const;
+	size_t getTraderCount() const;
+};
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include <chrono>
+#include <algorithm>
+
+#include "SimulationThread.h"
+
+SimulationThread::SimulationThread(const SimulationConfig& config, double stepsPerSecond, double publishInterval, size_t maxCatchUpSteps)
+	: config(config),
+	sim(std::make_unique<Simulation>(config)),
+	publishInterval(publishInterval),
+	maxCatchUpSteps(std::max<size_t>(1, maxCatchUpSteps)),
+	stepsPerSecond(stepsPerSecond)
+{
+	sim->addBookListener(this);
+	dropDeltas(); //The book already holds the scenario's opening orders
+
+	//Something to draw before the first step
+	publish();
+	snapshots.update();
+
+	worker = std::thread(&SimulationThread::run, this);
+}
+
+SimulationThread::~SimulationThread()
+{
+	stopping.store(true, std::memory_order_release);
+	worker.join();
+}
+
+template<Side S>
+static void applyDelta(std::vector<LevelInfo>& levels, const LevelDelta& delta)
+{
+	auto it = std::lower_bound(levels.begin(), levels.end(), delta.price,
+		[](const LevelInfo& level, Ticks price) { return typename BookSide<S>::Compare{}(level.price, price); });
+	bool found = it != levels.end() && it->price == delta.price;
+
+	if (delta.change == LevelChange::Removed) {
+		if (found) levels.erase(it);
+	}
+	else if (found) {
+		it->volume = delta.volume;
+		it->orderCount = delta.orderCount;
+	}
+	else {
+		levels.insert(it, { delta.price, delta.volume, delta.orderCount });
+	}
+}
+
+void SimulationThread::onLevel(const LevelDelta& delta)
+{
+	if (pendingDeltas.size() == MaxPendingDeltas) dropDeltas();
+	pendingDeltas.push_back(delta);
+}
+
+void SimulationThread::dropDeltas()
+{
+	//One past the end, so even a slot that had the whole log counts as behind
+	deltaBase += pendingDeltas.size() + 1;
+	pendingDeltas.clear();
+}
+
+void SimulationThread::publish()
+{
+	const LimitOrderBook& LOB = sim->getBook();
+	BookSnapshot& snapshot = snapshots.writeSlot();
+	uint64_t& slotDelta = slotDeltas[snapshots.writeIndex()];
+
+	snapshot.sequence = ++published;
+	snapshot.time = static_cast<TimeStamp>(sim->getClock().now());
+	snapshot.tradeCount = LOB.getTradeCount();
+
+	if (slotDelta < deltaBase) {
+		//Slots are reused, so this only allocates while the book is deeper than it has been before
+		snapshot.bids.resize(LOB.getBids().size());
+		snapshot.bids.resize(LOB.getTopLevels(BUY, snapshot.bids.data(), snapshot.bids.size()));
+		snapshot.asks.resize(LOB.getAsks().size());
+		snapshot.asks.resize(LOB.getTopLevels(SELL, snapshot.asks.data(), snapshot.asks.size()));
+	}
+	else {
+		for (size_t i = static_cast<size_t>(slotDelta - deltaBase); i < pendingDeltas.size(); i++) {
+			const LevelDelta& delta = pendingDeltas[i];
+			if (delta.side == BUY) applyDelta<BUY>(snapshot.bids, delta);
+			else applyDelta<SELL>(snapshot.asks, delta);
+		}
+	}
+	slotDelta = deltaBase + pendingDeltas.size();
+
+	snapshots.publish();
+
+	//Forget what every slot has taken
+	uint64_t oldest = std::min({ slotDeltas[0], slotDeltas[1], slotDeltas[2] });
+	if (oldest > deltaBase) {
+		pendingDeltas.erase(pendingDeltas.begin(), pendingDeltas.begin() + static_cast<ptrdiff_t>(oldest - deltaBase));
+		deltaBase = oldest;
+	}
+}
+
+void SimulationThread::run()
+{
+	using SteadyClock = std::chrono::steady_clock;
+
+	auto toDuration = [](double seconds) {
+		return std::chrono::duration_cast<SteadyClock::duration>(std::chrono::duration<double>(seconds));
+	};
+
+	//Naps are kept short so a speed change or skip doesn't wait out a slow step
+	const SteadyClock::duration maxNap = std::chrono::milliseconds(20);
+	SteadyClock::duration publishEvery = toDuration(publishInterval);
+
+	double pacedSpeed = 0.0; //The speed nextStep was scheduled for, 0 after running unpaced
+	SteadyClock::duration stepInterval{};
+	SteadyClock::time_point nextStep;
+
+	while (!stopping.load(std::memory_order_acquire))
+	{
+		if (checkpointAction.load(std::memory_order_acquire) != CheckpointAction::None && runCheckpointAction()) {
+			dropDeltas(); //A new book, whose orders came without deltas
+			publish();
+			pacedSpeed = 0.0;
+		}
+
+		double speed = stepsPerSecond.load(std::memory_order_relaxed);
+		long long target = skipTarget.load(std::memory_order_relaxed);
+		bool skipping = sim->getClock().now() < target;
+
+		if (skipping || speed <= 0.0) {
+			SteadyClock::time_point publishAt = SteadyClock::now() + publishEvery;
+			do {
+				sim->step();
+			} while (SteadyClock::now() < publishAt && !stopping.load(std::memory_order_relaxed) && (!skipping || sim->getClock().now() < target));
+
+			publish();
+			pacedSpeed = 0.0;
+			continue;
+		}
+
+		SteadyClock::time_point now = SteadyClock::now();
+		if (speed != pacedSpeed) {
+			//New pace (or back from a skip), start from here rather than owing the time before
+			pacedSpeed = speed;
+			stepInterval = toDuration(1.0 / speed);
+			nextStep = now;
+		}
+
+		if (now < nextStep) {
+			std::this_thread::sleep_until(std::min(nextStep, now + maxNap));
+			continue;
+		}
+
+		size_t steps = 0;
+		while (nextStep <= now && steps < maxCatchUpSteps) {
+			sim->step();
+			nextStep += stepInterval;
+			steps++;
+		}
+
+		//Too far behind, drop the backlog instead of chasing it
+		if (nextStep <= now) nextStep = now + stepInterval;
+
+		publish();
+	}
+}
+
+bool SimulationThread::runCheckpointAction()
+{
+	bool loading = checkpointAction.load(std::memory_order_relaxed) == CheckpointAction::Load;
+	std::string error;
+	bool done;
+
+	if (loading) {
+		//Loaded into a fresh simulation, so a file that fails halfway leaves the running one as it was
+		auto staged = std::make_unique<Simulation>(config);
+		done = staged->loadCheckpoint(checkpointPath, &error);
+		if (done) {
+			sim = std::move(staged);
+			sim->addBookListener(this);
+		}
+	}
+	else {
+		done = sim->saveCheckpoint(checkpointPath);
+	}
+
+	std::string result;
+	if (done) result = (loading ? "Restored " : "Saved ") + checkpointPath + " at tick " + std::to_string(sim->getClock().now());
+	else result = (loading ? "Error restoring checkpoint " : "Error writing checkpoint ") + checkpointPath + (error.empty() ? "" : ": " + error);
+
+	{
+		std::lock_guard<std::mutex> lock(resultMutex);
+		checkpointResult = result;
+	}
+
+	checkpointAction.store(CheckpointAction::None, std::memory_order_release);
+	return loading && done;
+}
+
+bool SimulationThread::requestSave(const std::string& path)
+{
+	if (checkpointAction.load(std::memory_order_acquire) != CheckpointAction::None) return false;
+
+	checkpointPath = path;
+	checkpointAction.store(CheckpointAction::Save, std::memory_order_release);
+	return true;
+}
+
+bool SimulationThread::requestLoad(const std::string& path)
+{
+	if (checkpointAction.load(std::memory_order_acquire) != CheckpointAction::None) return false;
+
+	checkpointPath = path;
+	checkpointAction.store(CheckpointAction::Load, std::memory_order_release);
+	return true;
+}
+
+bool SimulationThread::takeCheckpointResult(std::string& message)
+{
+	std::lock_guard<std::mutex> lock(resultMutex);
+	if (checkpointResult.empty()) return false;
+
+	message.swap(checkpointResult);
+	checkpointResult.clear();
+	return true;
+}
+
+void SimulationThread::setSpeed(double stepsPerSecond)
+{
+	this->stepsPerSecond.store(std::max(0.0, stepsPerSecond), std::memory_order_relaxed);
+}
+
+double SimulationThread::getSpeed() const
+{
+	return stepsPerSecond.load(std::memory_order_relaxed);
+}
+
+void SimulationThread::skipTo(long long time)
+{
+	skipTarget.store(time, std::memory_order_relaxed);
+}
+
+long long SimulationThread::getSkipTarget() const
+{
+	return skipTarget.load(std::memory_order_relaxed);
+}
+
+bool SimulationThread::update()
+{
+	return snapshots.update();
+}
+
+const BookSnapshot& SimulationThread::getSnapshot() const
+{
+	return snapshots.read();
+}
\ No newline at end of file
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+#include <string>
+
+#include "datatypes.h"
+#include "Simulation.h"
+#include "BookListener.h"
+#include "TripleBuffer.h"
+
+//Every resting level of the book at one point in time, best first
+struct BookSnapshot
+{
+	uint64_t sequence = 0; //Counts publishes, so a reader can tell a new snapshot from the last one
+	TimeStamp time = 0;
+	size_t tradeCount = 0;
+
+	std::vector<LevelInfo> bids;
+	std::vector<LevelInfo> asks;
+};
+
+//Runs a Simulation on its own thread and publishes a BookSnapshot after every burst of
+//steps, so a renderer can draw at its own rate without locking the book. The simulation
+//must not be touched from outside while the thread runs. Snapshots follow the book's level
+//deltas, so a publish costs the levels that changed since that slot was last written
+//rather than a copy of the whole book.
+//
+//stepsPerSecond paces the clock against wall time, catching up on missed steps but never
+//more than maxCatchUpSteps per burst. A backlog past that is dropped, so a slow machine runs
+//the market slower instead of never publishing. 0 runs flat out and publishes about every
+//publishInterval seconds, as does a skip.
+class SimulationThread : private BookListener
+{
+private:
+	SimulationConfig config;
+	std::unique_ptr<Simulation> sim; //Replaced as a whole by a successful load
+	double publishInterval;
+	size_t maxCatchUpSteps;
+
+	std::atomic<double> stepsPerSecond;
+	std::atomic<long long> skipTarget{ 0 };
+
+	TripleBuffer<BookSnapshot> snapshots;
+	uint64_t published = 0;
+
+	//Deltas not every slot has taken yet, numbered from deltaBase. Slot i holds every delta
+	//before slotDeltas[i], and one that is behind the log is rebuilt from the book instead.
+	static constexpr size_t MaxPendingDeltas = 1 << 16; //Past this, e.g. while nothing is drawn, the log is dropped
+	std::vector<LevelDelta> pendingDeltas;
+	uint64_t deltaBase = 0;
+	uint64_t slotDeltas[3] = {};
+
+	enum class CheckpointAction : uint8_t
+	{
+		None,
+		Save,
+		Load
+	};
+
+	std::atomic<CheckpointAction> checkpointAction{ CheckpointAction::None };
+	std::string checkpointPath; //Set by the caller only while no action is pending
+
+	std::mutex resultMutex;
+	std::string checkpointResult; //How the last action went, empty once taken
+
+	std::atomic<bool> stopping{ false };
+	std::thread worker;
+
+	void run();
+	void publish();
+	void onLevel(const LevelDelta& delta) override;
+	void dropDeltas(); //Every slot is rebuilt on its next publish
+	bool runCheckpointAction(); //True after a successful load
+public:
+	explicit SimulationThread(const SimulationConfig& config, double stepsPerSecond = 10.0, double publishInterval = 1.0 / 240.0, size_t maxCatchUpSteps = 1000);
+	~SimulationThread();
+
+	SimulationThread(const SimulationThread&) = delete;
+	SimulationThread& operator=(const SimulationThread&) = delete;
+
+	//Safe from any thread, picked up within a few milliseconds
+	void setSpeed(double stepsPerSecond); //0 runs flat out
+	double getSpeed() const;
+	void skipTo(long long time); //Runs flat out until the clock reaches time, then back to the set speed
+	long long getSkipTarget() const;
+
+	//Saves or loads a Simulation checkpoint on the simulation thread before its next burst.
+	//A load that fails keeps the simulation that was running. False if the previous request
+	//hasn't been handled yet.
+	bool requestSave(const std::string& path);
+	bool requestLoad(const std::string& path);
+	bool takeCheckpointResult(std::string& message); //A line saying how the last request went, once
+
+	//Render thread only. Picks up the newest snapshot if there is one, returns true if so.
+	bool update();
+	const BookSnapshot& getSnapshot() const;
+};
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+//Bounded lock-free ring for exactly one producer thread and one consumer thread
+template<class T>
+class SpscQueue
+{
+private:
+	std::vector<T> buffer;
+	size_t mask;
+
+	alignas(64) std::atomic<size_t> head{ 0 }; //Next slot to read, owned by the consumer
+	alignas(64) std::atomic<size_t> tail{ 0 }; //Next slot to write, owned by the producer
+public:
+	explicit SpscQueue(size_t capacity)
+	{
+		size_t rounded = 2;
+		while (rounded < capacity) rounded <<= 1;
+
+		buffer.resize(rounded);
+		mask = rounded - 1;
+	}
+
+	SpscQueue(const SpscQueue&) = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	bool tryPush(const T& value)
+	{
+		size_t t = tail.load(std::memory_order_relaxed);
+		if (t - head.load(std::memory_order_acquire) == buffer.size()) return false;
+
+		buffer[t & mask] = value;
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool tryPop(T& value)
+	{
+		size_t h = head.load(std::memory_order_relaxed);
+		if (h == tail.load(std::memory_order_acquire)) return false;
+
+		value = buffer[h & mask];
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool empty() const
+	{
+		return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+	}
+
+	size_t capacity() const { return buffer.size(); }
+};
\ No newline at end of file
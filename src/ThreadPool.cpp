@@ -0,0 +1,87 @@
+#include <algorithm>
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(size_t threads)
+{
+	if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+	workers.reserve(threads - 1);
+	for (size_t i = 1; i < threads; i++) {
+		workers.emplace_back(&ThreadPool::workerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (auto& worker : workers) worker.join();
+}
+
+size_t ThreadPool::getThreadCount() const
+{
+	return workers.size() + 1;
+}
+
+void ThreadPool::runChunks()
+{
+	while (true)
+	{
+		size_t start = nextIndex.fetch_add(chunkSize, std::memory_order_relaxed);
+		if (start >= jobCount) break;
+
+		size_t end = std::min(start + chunkSize, jobCount);
+		for (size_t i = start; i < end; i++) (*job)(i);
+	}
+}
+
+void ThreadPool::workerLoop()
+{
+	uint64_t seenGeneration = 0;
+
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&] { return stopping || generation != seenGeneration; });
+			if (stopping) return;
+			seenGeneration = generation;
+		}
+
+		runChunks();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (--pendingWorkers == 0) done.notify_one();
+	}
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& fn)
+{
+	if (workers.empty() || count < 2) {
+		for (size_t i = 0; i < count; i++) fn(i);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job = &fn;
+		jobCount = count;
+		//Several chunks per thread so uneven strategies still balance out
+		chunkSize = std::max<size_t>(1, count / (getThreadCount() * 8));
+		nextIndex.store(0, std::memory_order_relaxed);
+		pendingWorkers = workers.size();
+		generation++;
+	}
+	wake.notify_all();
+
+	runChunks();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	done.wait(lock, [&] { return pendingWorkers == 0; });
+	job = nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+//Fixed set of workers for data-parallel loops. The calling thread joins in,
+//so a pool of N threads runs N - 1 workers.
+class ThreadPool
+{
+private:
+	std::vector<std::thread> workers;
+
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable done;
+
+	const std::function<void(size_t)>* job = nullptr;
+	size_t jobCount = 0;
+	size_t chunkSize = 1;
+	std::atomic<size_t> nextIndex{ 0 };
+
+	uint64_t generation = 0;
+	size_t pendingWorkers = 0;
+	bool stopping = false;
+
+	void workerLoop();
+	void runChunks();
+public:
+	explicit ThreadPool(size_t threads = 0); //0 uses every hardware thread
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	//Calls fn(i) for every i in [0, count) and returns once all calls finished
+	void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+	size_t getThreadCount() const;
+};
\ No newline at end of file
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <vector>
+
+#include "datatypes.h"
+
 class Trader;
 class LimitOrderBook;
 class Clock;
@@ -7,5 +11,6 @@ class Clock;
 class TradeStrategy
 {
 public:
-	virtual void decide(Trader& trader, LimitOrderBook& LOB, Clock& clock) = 0;
+	//Reads the book and emits commands, it must not touch anything but trader and commands
+	virtual void decide(Trader& trader, const LimitOrderBook& LOB, const Clock& clock, std::vector<Command>& commands) = 0;
 };
\ No newline at end of file
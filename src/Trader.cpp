@@ -1,54 +1,80 @@
 #include "Trader.h"
 #include "TrendStrategy.h"
 
-Trader::Trader(TradeStrategy* strategy, long id, double funds, long stocks)
+Trader::Trader(TradeStrategy* strategy, TraderRegistry& registry, TraderId id, double funds, long stocks)
 	: strategy(strategy),
-	id(id),
-	funds(funds),
-	stocks(stocks)
-{}
+	registry(&registry),
+	id(id)
+{
+	registry.add(id, funds, stocks);
+}
 
-long Trader::getId() const
+TraderId Trader::getId() const
 {
 	return id;
 }
 
 double Trader::getFunds() const
 {
-	return funds;
+	return registry->getFunds(id);
 }
 
-double Trader::getStocks() const
+double Trader::getStocks(SymbolId symbol) const
 {
-	return stocks;
+	return registry->getPosition(id, symbol);
 }
 
-const std::vector<long>& Trader::getActiveOrderIds() const
+const std::vector<OrderId>& Trader::getActiveOrderIds(SymbolId symbol) const
 {
-	return activeOrders;
+	return registry->getActiveOrderIds(id, symbol);
 }
 
 void Trader::changeFunds(double funds)
 {
-	this->funds += funds;
+	registry->changeFunds(id, funds);
+}
+
+void Trader::changeStocks(long stocks, SymbolId symbol)
+{
+	registry->changePosition(id, stocks, symbol);
+}
+
+void Trader::update(const LimitOrderBook& LOB, const Clock& clock, std::vector<Command>& commands)
+{
+	strategy->decide(*this, LOB, clock, commands);
+}
+
+long long Trader::getWakeInterval() const
+{
+	return wakeInterval;
+}
+
+void Trader::setWakeInterval(long long ticks)
+{
+	wakeInterval = ticks;
+}
+
+Rng& Trader::getRng()
+{
+	return rng;
 }
 
-void Trader::changeStocks(long stocks)
+const Rng& Trader::getRng() const
 {
-	this->stocks += stocks;
+	return rng;
 }
 
-void Trader::update(LimitOrderBook& LOB, Clock& clock)
+void Trader::seedRng(uint64_t seed)
 {
-	strategy->decide(*this, LOB, clock);
+	rng.reseed(seed, id);
 }
 
-void Trader::addActiveOrderId(long id)
+void Trader::addActiveOrderId(OrderId orderId, SymbolId symbol)
 {
-	activeOrders.push_back(id);
+	registry->addActiveOrderId(id, orderId, symbol);
 }
 
-void Trader::clearActiveOrderIds()
+void Trader::clearActiveOrderIds(SymbolId symbol)
 {
-	activeOrders.clear();
+	registry->clearActiveOrderIds(id, symbol);
 }
\ No newline at end of file
@@ -2,7 +2,10 @@
 
 #include <vector>
 
+#include "datatypes.h"
 #include "TradeStrategy.h"
+#include "Rng.h"
+#include "TraderRegistry.h"
 
 enum TraderType
 {
@@ -12,28 +15,40 @@ enum TraderType
 	Whale
 };
 
+//A strategy and its random stream. The account (funds, positions, active orders) lives in
+//the registry under the trader's id, the trader just forwards to it.
 class Trader {
 private:
 	TradeStrategy* strategy;
+	TraderRegistry* registry;
 
-	long id;
-	double funds;
-	long stocks;
+	TraderId id;
+	long long wakeInterval = 0; //Ticks until the next decision, 0 for every step
 
-	std::vector<long> activeOrders;
+	Rng rng;
 public:
-	Trader(TradeStrategy* strategy, long id, double funds, long stocks);
+	Trader(TradeStrategy* strategy, TraderRegistry& registry, TraderId id, double funds, long stocks);
 
-	long getId() const;
+	TraderId getId() const;
 	double getFunds() const;
-	double getStocks() const;
-	const std::vector<long>& getActiveOrderIds() const;
+	double getStocks(SymbolId symbol = 0) const;
+	//Ids of orders and stops sent with trackActive, listed until the strategy clears them
+	//whether or not they have filled since
+	const std::vector<OrderId>& getActiveOrderIds(SymbolId symbol = 0) const;
 
 	void changeFunds(double funds);
-	void changeStocks(long stocks);
+	void changeStocks(long stocks, SymbolId symbol = 0);
 	
-	void update(LimitOrderBook& LOB, Clock& clock);
+	void update(const LimitOrderBook& LOB, const Clock& clock, std::vector<Command>& commands);
 
-	void addActiveOrderId(long id);
-	void clearActiveOrderIds();
+	//A strategy may change this while deciding to sleep longer or come back sooner
+	long long getWakeInterval() const;
+	void setWakeInterval(long long ticks);
+
+	Rng& getRng();
+	const Rng& getRng() const;
+	void seedRng(uint64_t seed);
+
+	void addActiveOrderId(OrderId orderId, SymbolId symbol = 0);
+	void clearActiveOrderIds(SymbolId symbol = 0);
 };
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "TraderRegistry.h"
+
+void TraderRegistry::ensureSymbol(SymbolId symbol)
+{
+	if (symbol < positions.size()) return;
+
+	positions.resize(symbol + 1);
+	activeOrders.resize(symbol + 1);
+	for (size_t s = 0; s <= symbol; s++) {
+		positions[s].resize(funds.size(), 0);
+		activeOrders[s].resize(funds.size());
+	}
+}
+
+void TraderRegistry::add(TraderId id, double funds, long stocks, SymbolId symbol)
+{
+	if (id >= this->funds.size()) {
+		size_t count = static_cast<size_t>(id) + 1;
+		registered.resize(count, 0);
+		this->funds.resize(count, 0.0);
+		for (auto& held : positions) held.resize(count, 0);
+		for (auto& orders : activeOrders) orders.resize(count);
+	}
+
+	ensureSymbol(symbol);
+
+	registered[id] = 1;
+	this->funds[id] = funds;
+	positions[symbol][id] = stocks;
+}
+
+long TraderRegistry::getPosition(TraderId id, SymbolId symbol) const
+{
+	return symbol < positions.size() ? positions[symbol][id] : 0;
+}
+
+const std::vector<OrderId>& TraderRegistry::getActiveOrderIds(TraderId id, SymbolId symbol) const
+{
+	static const std::vector<OrderId> none;
+	return symbol < activeOrders.size() ? activeOrders[symbol][id] : none;
+}
+
+void TraderRegistry::changePosition(TraderId id, long amount, SymbolId symbol)
+{
+	ensureSymbol(symbol);
+	positions[symbol][id] += amount;
+}
+
+void TraderRegistry::addActiveOrderId(TraderId id, OrderId orderId, SymbolId symbol)
+{
+	ensureSymbol(symbol);
+	activeOrders[symbol][id].push_back(orderId);
+}
+
+void TraderRegistry::clearActiveOrderIds(TraderId id, SymbolId symbol)
+{
+	if (symbol < activeOrders.size()) activeOrders[symbol][id].clear();
+}
+
+void TraderRegistry::settle(const TradeRecord& trade, SymbolId symbol)
+{
+	ensureSymbol(symbol);
+	double cashExchanged = toPrice(trade.price) * trade.volume;
+	std::vector<long>& held = positions[symbol];
+
+	if (contains(trade.buyerId)) {
+		funds[trade.buyerId] -= cashExchanged;
+		held[trade.buyerId] += trade.volume;
+	}
+
+	if (contains(trade.sellerId)) {
+		funds[trade.sellerId] += cashExchanged;
+		held[trade.sellerId] -= trade.volume;
+	}
+}
+
+void TraderRegistry::saveState(CheckpointWriter& writer) const
+{
+	writer.writeVector(registered);
+	writer.writeVector(funds);
+
+	writer.write<uint64_t>(positions.size());
+	for (size_t s = 0; s < positions.size(); s++) {
+		writer.writeVector(positions[s]);
+		for (const auto& orders : activeOrders[s]) writer.writeVector(orders);
+	}
+}
+
+bool TraderRegistry::loadState(CheckpointReader& reader)
+{
+	size_t symbols;
+	if (!reader.readVector(registered) || !reader.readVector(funds) || registered.size() != funds.size()
+		|| !reader.readCount(symbols, sizeof(uint64_t))) return false;
+
+	positions.assign(symbols, {});
+	activeOrders.assign(symbols, {});
+
+	for (size_t s = 0; s < symbols; s++) {
+		if (!reader.readVector(positions[s]) || positions[s].size() != funds.size()) return false;
+
+		activeOrders[s].resize(funds.size());
+		for (auto& orders : activeOrders[s]) {
+			if (!reader.readVector(orders)) return false;
+		}
+	}
+	return true;
+}
\ No newline at end of file
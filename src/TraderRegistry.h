@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+
+#include "datatypes.h"
+#include "Checkpoint.h"
+
+//Every trader's account, indexed directly by TraderId. Funds, positions and active orders
+//sit in their own arrays so settlement is a couple of indexed updates.
+//Ids are expected to be dense (0..N-1), a gap just leaves an empty account.
+//Trades involving an id that was never added settle only the other side.
+class TraderRegistry
+{
+private:
+	std::vector<uint8_t> registered;
+	std::vector<double> funds;
+	std::vector<std::vector<long>> positions; //[symbol][trader], symbols added on first use
+	std::vector<std::vector<std::vector<OrderId>>> activeOrders; //[symbol][trader]
+
+	void ensureSymbol(SymbolId symbol);
+public:
+	void add(TraderId id, double funds, long stocks, SymbolId symbol = 0);
+
+	size_t size() const { return funds.size(); }
+	bool contains(TraderId id) const { return id < registered.size() && registered[id]; }
+
+	double getFunds(TraderId id) const { return funds[id]; }
+	long getPosition(TraderId id, SymbolId symbol = 0) const;
+	const std::vector<OrderId>& getActiveOrderIds(TraderId id, SymbolId symbol = 0) const;
+
+	void changeFunds(TraderId id, double amount) { funds[id] += amount; }
+	void changePosition(TraderId id, long amount, SymbolId symbol = 0);
+	void addActiveOrderId(TraderId id, OrderId orderId, SymbolId symbol = 0);
+	void clearActiveOrderIds(TraderId id, SymbolId symbol = 0);
+
+	void settle(const TradeRecord& trade, SymbolId symbol);
+
+	void saveState(CheckpointWriter& writer) const;
+	bool loadState(CheckpointReader& reader); //Replaces every account
+};
\ No newline at end of file
@@ -5,33 +5,44 @@
 #include "Trader.h"
 #include "LimitOrderBook.h"
 #include "Clock.h"
+#include "Profiler.h"
 
-void TrendStrategy::decide(Trader& trader, LimitOrderBook& LOB, Clock& clock)
+//Between the signal's share and a fifth of what the trader can trade
+static long pickVolume(Rng& rng, long available, double strength)
 {
-	static std::mt19937 rng(std::random_device{}());
-	size_t depth = 100; //How many last trades to look at
+	long minVol = static_cast<long>(available * strength);
+	long maxVol = static_cast<long>(available * 0.2);
 
-	auto const& midPriceHistory = LOB.getMidPriceHistory();
+	if (minVol >= maxVol) minVol = maxVol / 2;
+	std::uniform_int_distribution<long> dist(std::max(1L, minVol), std::max(1L, maxVol));
 
-	if (midPriceHistory.empty())
-		return;
+	return std::clamp(
+		dist(rng),
+		1L,
+		available
+	);
+}
 
-	double sum = 0;
-	size_t count = 0;
-	for (auto it = midPriceHistory.rbegin();
-		it != midPriceHistory.rend() && count < depth;
-		++it, ++count)
-	{
-		sum += *it;
-	}
+void TrendStrategy::decide(Trader& trader, const LimitOrderBook& LOB, const Clock& clock, std::vector<Command>& commands)
+{
+	MARKETSIM_PROFILE_SCOPE(Probe::TrendDecide);
+
+	Rng& rng = trader.getRng();
+	const MarketIndicators& indicators = LOB.getIndicators();
+	SymbolId symbol = LOB.getSymbol();
+
+	if (indicators.getSampleCount() == 0)
+		return;
 
-	size_t actualDepth = std::min(depth, midPriceHistory.size());
-	double avr = sum / actualDepth;
+	double avr = indicators.getSma();
 
 	if (avr <= 0.0) return;
 
-	double currentPrice = midPriceHistory.back();
-	double diff = currentPrice - avr;
+	//Last wake's stops are re-placed around the new average, along with whatever a triggered one left resting
+	for (OrderId id : trader.getActiveOrderIds(symbol)) {
+		commands.push_back(makeCancelCommand(id));
+	}
+	trader.clearActiveOrderIds(symbol);
 
 	double threshold = avr * 0.001;
 
@@ -41,7 +52,7 @@ void TrendStrategy::decide(Trader& trader, LimitOrderBook& LOB, Clock& clock)
 	}
 
 	bool cashOut = false;
-	if (trader.getStocks() >= 300) {
+	if (trader.getStocks(symbol) >= 300) {
 		cashOut = true;
 	}
 
@@ -49,71 +60,35 @@ void TrendStrategy::decide(Trader& trader, LimitOrderBook& LOB, Clock& clock)
 		auto const& bids = LOB.getBids();
 		if (bids.empty())  return;
 
-		double executionPrice = bids.begin()->first * 0.99;
-		long amountToDump = trader.getStocks() / 10;
-		Order sellOrder = { 0, trader.getId(), executionPrice, amountToDump, Side::SELL, clock.now() };
-		LOB.processOrder(sellOrder, clock);
+		double executionPrice = toPrice(bids.bestPrice()) * 0.99;
+		long amountToDump = trader.getStocks(symbol) / 10;
+		Order sellOrder = makeOrder(trader.getId(), Side::SELL, executionPrice, amountToDump, clock.now());
+		commands.push_back(makeOrderCommand(sellOrder, false));
 	}
 
-	if (diff > threshold && !cashOut)
+	//Follow a breakout either way: stops that fire once a trade prints threshold past the
+	//average, paying at most 1% beyond the trigger
+	if (!cashOut)
 	{
-		auto const& asks = LOB.getAsks();
-		if (asks.empty()) return;
-
-		auto bestAskIt = asks.begin();
-
-		double executionPrice = bestAskIt->first * 1.01;
-
-		double funds = trader.getFunds();
-		long canBuy = static_cast<long>(std::floor(funds / executionPrice));
-
-		if (canBuy <= 0) return;
-
-		double perc = diff / avr;
-
-		long minVol = static_cast<long>(canBuy * perc);
-		long maxVol = static_cast<long>(canBuy * 0.2);
-
-		if (minVol >= maxVol) minVol = maxVol / 2;
-		std::uniform_int_distribution<long> dist(std::max(1L, minVol), std::max(1L, maxVol));
-
-		long willBuy = std::clamp(
-			dist(rng), 
-			1L,
-			canBuy
-		);
-
-		Order order = { 0, trader.getId(), executionPrice, willBuy, Side::BUY, clock.now()};
-		LOB.processOrder(order, clock);
+		double triggerPrice = avr + threshold;
+		double limitPrice = triggerPrice * 1.01;
+		long canBuy = static_cast<long>(std::floor(trader.getFunds() / limitPrice));
+
+		if (canBuy > 0) {
+			Order order = makeOrder(trader.getId(), Side::BUY, limitPrice, pickVolume(rng, canBuy, threshold / avr), clock.now());
+			commands.push_back(makeStopCommand(order, toTicks(triggerPrice), StopKind::Limit, true));
+		}
 	}
-	else if (diff < -threshold && !buyingTheDip)
-	{
-		auto const& bids = LOB.getBids();
-		if (bids.empty()) return;
-
-		auto bestBidIt = bids.begin();
-
-		double executionPrice = bestBidIt->first * 0.99;
 
-		long canSell = trader.getStocks();
-
-		if (canSell <= 0) return;
-
-		double perc = std::abs(diff) / avr;
-
-		long minVol = static_cast<long>(canSell * perc);
-		long maxVol = static_cast<long>(canSell * 0.2);
-
-		if (minVol >= maxVol) minVol = maxVol / 2;
-		std::uniform_int_distribution<long> dist(std::max(1L, minVol), std::max(1L, maxVol));
-
-		long willSell = std::clamp(
-			dist(rng),
-			1L,
-			canSell
-		);
-
-		Order order = { 0, trader.getId(), executionPrice, willSell, Side::SELL, clock.now() };
-		LOB.processOrder(order, clock);
+	if (!buyingTheDip)
+	{
+		double triggerPrice = avr - threshold;
+		double limitPrice = triggerPrice * 0.99;
+		long canSell = trader.getStocks(symbol);
+
+		if (canSell > 0) {
+			Order order = makeOrder(trader.getId(), Side::SELL, limitPrice, pickVolume(rng, canSell, threshold / avr), clock.now());
+			commands.push_back(makeStopCommand(order, toTicks(triggerPrice), StopKind::Limit, true));
+		}
 	}
 }
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+//Lock-free hand-off of the latest value from one writer thread to one reader thread.
+//The writer fills writeSlot() and publishes it, the reader picks up the newest published
+//value with update() and reads it until the next update(). Neither side ever waits, and
+//values the reader never got to are simply overwritten.
+template<class T>
+class TripleBuffer
+{
+private:
+	static constexpr uint8_t IndexMask = 0x3;
+	static constexpr uint8_t FreshBit = 0x4;
+
+	T slots[3];
+
+	alignas(64) std::atomic<uint8_t> middle{ 1 }; //Slot between the two sides, FreshBit when it holds an unread value
+	alignas(64) uint8_t back = 0; //Owned by the writer
+	alignas(64) uint8_t front = 2; //Owned by the reader
+public:
+	TripleBuffer() = default;
+
+	TripleBuffer(const TripleBuffer&) = delete;
+	TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+	T& writeSlot() { return slots[back]; }
+	uint8_t writeIndex() const { return back; } //Which of the three slots writeSlot() is, until the next publish()
+
+	void publish()
+	{
+		back = middle.exchange(back | FreshBit, std::memory_order_acq_rel) & IndexMask;
+	}
+
+	//Returns true when a newer value was picked up
+	bool update()
+	{
+		if (!(middle.load(std::memory_order_relaxed) & FreshBit)) return false;
+
+		front = middle.exchange(front, std::memory_order_acq_rel) & IndexMask;
+		return true;
+	}
+
+	const T& read() const { return slots[front]; }
+};
\ No newline at end of file
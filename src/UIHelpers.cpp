@@ -1,7 +1,6 @@
-#include <iomanip>
-#include <sstream>
 #include <string>
-#include <ios>
+#include <cmath>
+#include <charconv>
 #include <SFML/Graphics/RenderWindow.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/Font.hpp>
@@ -12,11 +11,28 @@
 
 #include "UIHelpers.h"
 
-std::string UIHelper::formatPrice(double price)
+size_t UIHelper::formatPrice(double price, char* out)
 {
-    std::stringstream ss;
-    ss << std::fixed << std::setprecision(2) << price;
-    return ss.str();
+    long long cents = std::llround(price * 100.0);
+    char* end = out;
+
+    if (cents < 0)
+    {
+        *end++ = '-';
+        cents = -cents;
+    }
+
+    end = std::to_chars(end, out + NumberBufferSize - 3, cents / 100).ptr;
+    *end++ = '.';
+    *end++ = static_cast<char>('0' + (cents / 10) % 10);
+    *end++ = static_cast<char>('0' + cents % 10);
+
+    return static_cast<size_t>(end - out);
+}
+
+size_t UIHelper::formatVolume(long volume, char* out)
+{
+    return static_cast<size_t>(std::to_chars(out, out + NumberBufferSize, volume).ptr - out);
 }
 
 void UIHelper::drawLabel(sf::RenderTarget& target, const sf::Font& font, const std::string& label, int fontSize, float x, float y, TextSnap snap, float offset, sf::Color color)
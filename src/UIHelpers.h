@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <cstddef>
 #include <SFML/Graphics/Font.hpp>
 #include <SFML/Graphics/Color.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
@@ -25,7 +26,11 @@ enum class TextSnap { Left, Center, Right };
 class UIHelper
 {
 public:
-    static std::string formatPrice(double price);
+    static constexpr size_t NumberBufferSize = 24;
+
+    //Write into out (NumberBufferSize chars) without allocating and return the length
+    static size_t formatPrice(double price, char* out); //Two decimals
+    static size_t formatVolume(long volume, char* out);
 
     static void drawLabel(sf::RenderTarget& target, const sf::Font& font, const std::string& label, int fontSize, float x, float y, TextSnap snap, float offset, sf::Color color);
     static void drawColoredRect(sf::RenderTarget& target, float x, float y, float width, float height, TextSnap snap, float offset, sf::Color color);
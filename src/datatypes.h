@@ -6,8 +6,35 @@
 #include <unordered_map>
 #include <functional>
 #include <cmath>
+#include <cstdint>
+#include <limits>
 
-enum Side
+//Prices live in the engine as integer ticks, doubles only at the strategy/UI edges
+using Ticks = int32_t;
+using Volume = int32_t;
+using OrderId = uint32_t;
+using TraderId = uint32_t;
+using TimeStamp = uint32_t;
+using SymbolId = uint32_t;
+
+inline constexpr double TICK_SIZE = 0.01;
+
+//Clamped to the Ticks range, a price too large to represent stays at the far end instead of wrapping
+inline Ticks toTicks(double price)
+{
+	double ticks = std::round(price / TICK_SIZE);
+	if (std::isnan(ticks)) return 0;
+	if (ticks <= std::numeric_limits<Ticks>::lowest()) return std::numeric_limits<Ticks>::lowest();
+	if (ticks >= std::numeric_limits<Ticks>::max()) return std::numeric_limits<Ticks>::max();
+	return static_cast<Ticks>(ticks);
+}
+
+inline constexpr double toPrice(Ticks ticks)
+{
+	return ticks * TICK_SIZE;
+}
+
+enum Side : uint8_t
 {
 	BUY,
 	SELL
@@ -15,22 +42,117 @@ enum Side
 
 struct Order
 {
-	long id;
-	long traderId;
-	double price;
-	long volume;
+	OrderId id;
+	TraderId traderId;
+	Ticks price;
+	Volume volume;
 	Side side;
-	long long timeStamp;
+	TimeStamp timeStamp;
+};
+
+static_assert(sizeof(Order) == 24, "Order should stay packed, it is copied on every match");
+
+//What a stop goes in as once its trigger prints
+enum class StopKind : uint8_t
+{
+	Market, //Takes whatever the other side has, the rest is dropped
+	Limit //A limit order at order.price
+};
+
+inline Order makeOrder(TraderId traderId, Side side, double price, long volume, long long timeStamp)
+{
+	return { 0, traderId, toTicks(price), static_cast<Volume>(volume), side, static_cast<TimeStamp>(timeStamp) };
+}
+
+enum class CommandType : uint8_t
+{
+	NewOrder,
+	Cancel,
+	Amend,
+	Quote,
+	Stop
+};
+
+//What a strategy asks the book to do, applied after the decide phase
+struct Command
+{
+	CommandType type;
+	bool trackActive; //Hand the assigned id back to the trader (Trader::getActiveOrderIds), e.g. to cancel it next wake
+	OrderId targetId; //Cancel and Amend
+	Order order; //NewOrder and Stop, the new price and volume for Amend, the bid for Quote
+	Order quoteAsk; //Quote only
+	Ticks triggerPrice; //Stop only
+	StopKind stopKind; //Stop only
+};
+
+inline Command makeOrderCommand(const Order& order, bool trackActive)
+{
+	return { CommandType::NewOrder, trackActive, 0, order, {}, 0, StopKind::Market };
+}
+
+inline Command makeCancelCommand(OrderId orderId)
+{
+	return { CommandType::Cancel, false, orderId, {}, {}, 0, StopKind::Market };
+}
+
+inline Command makeAmendCommand(OrderId orderId, Ticks price, Volume volume)
+{
+	Command command = { CommandType::Amend, false, orderId, {}, {}, 0, StopKind::Market };
+	command.order.price = price;
+	command.order.volume = volume;
+	return command;
+}
+
+//Replaces the trader's standing two-sided quote, see LimitOrderBook::massQuote
+inline Command makeQuoteCommand(const Order& bid, const Order& ask)
+{
+	return { CommandType::Quote, false, 0, bid, ask, 0, StopKind::Market };
+}
+
+//order.price is the limit once triggered and is ignored for StopKind::Market
+inline Command makeStopCommand(const Order& order, Ticks triggerPrice, StopKind kind, bool trackActive)
+{
+	return { CommandType::Stop, trackActive, 0, order, {}, triggerPrice, kind };
+}
+
+//What a command did when applied through LimitOrderBook::processBatch
+struct CommandResult
+{
+	OrderId orderId; //NewOrder/Stop: the id it was given, Cancel/Amend: the target
+	bool applied; //false if a Cancel or Amend found no resting order
 };
 
 struct TradeRecord
 {
-	long tradeId;
-	double price;
+	uint32_t tradeId;
+	Ticks price;
+	Volume volume;
+	TraderId buyerId;
+	TraderId sellerId;
+	TimeStamp timeStamp;
+};
+
+static_assert(sizeof(TradeRecord) == 24, "TradeRecord should stay packed");
+
+inline constexpr uint32_t NilSlot = UINT32_MAX;
+
+//FIFO of resting orders, linked through OrderPool slots
+struct PriceLevel
+{
+	Ticks price;
+	uint32_t head = NilSlot;
+	uint32_t tail = NilSlot;
+	uint32_t orderCount = 0;
+	long totalVolume = 0;
+
+	bool empty() const { return head == NilSlot; }
+};
+
+struct LevelInfo
+{
+	Ticks price;
 	long volume;
-	long buyerOrderId;
-	long sellerOrderId;
-	long long timeStamp;
+	uint32_t orderCount;
 };
 
 struct DepthPoint {
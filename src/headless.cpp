@@ -0,0 +1,310 @@
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <algorithm>
+
+#include "Simulation.h"
+#include "ExchangeSimulation.h"
+#include "Ensemble.h"
+#include "Journal.h"
+#include "MarketData.h"
+#include "Profiler.h"
+
+static void printUsage(const char* exe)
+{
+    std::cout << "Usage: " << exe << " [--ticks N] [--trend N] [--random N] [--seed N] [--parallel] [--threads N] [--journal FILE] [--export FILE] [--symbols N] [--runs N] [--retain N]" << std::endl;
+    std::cout << "       " << exe << " ... [--trend-wake TICKS] [--random-wake TICKS] [--latency TICKS] [--profile FILE]" << std::endl;
+    std::cout << "       " << exe << " ... [--restore FILE] [--checkpoint FILE]" << std::endl;
+    std::cout << "       " << exe << " --replay FILE" << std::endl;
+    std::cout << "       " << exe << " --to-csv FILE PREFIX" << std::endl;
+}
+
+static int runExchange(const SimulationConfig& config, size_t symbols, long long ticks)
+{
+    ExchangeSimulation sim(config, symbols);
+    const Exchange& exchange = sim.getExchange();
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (long long i = 0; i < ticks; i++)
+    {
+        sim.step();
+    }
+    sim.sync();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double seconds = elapsed.count();
+
+    size_t orders = 0;
+    size_t trades = 0;
+    for (SymbolId s = 0; s < exchange.getSymbolCount(); s++)
+    {
+        orders += exchange.getBook(s).getOrderCount();
+        trades += exchange.getBook(s).getTradeCount();
+    }
+
+    std::cout << "Ran " << ticks << " ticks on " << symbols << " symbols with " << sim.getTraderCount() << " traders in " << seconds << " s"
+        << (config.parallelDecide ? " (parallel decide)" : "") << std::endl;
+    std::cout << "  seed:       " << config.seed << std::endl;
+    std::cout << "  ticks/sec:  " << ticks / seconds << std::endl;
+    std::cout << "  orders/sec: " << orders / seconds << " (" << orders << " orders)" << std::endl;
+    std::cout << "  trades/sec: " << trades / seconds << " (" << trades << " trades)" << std::endl;
+
+    for (SymbolId s = 0; s < exchange.getSymbolCount(); s++)
+    {
+        const LimitOrderBook& book = exchange.getBook(s);
+        if (book.getMidPriceHistory().empty()) continue;
+        std::cout << "  symbol " << s << ": " << book.getTradeCount() << " trades, final mid " << book.getMidPriceHistory().back() << std::endl;
+    }
+
+    return 0;
+}
+
+static void printStats(const char* name, const RunningStats& stats, const Ensemble& ensemble, double RunSummary::* field)
+{
+    std::cout << "  " << name << " mean " << stats.getMean() << ", sd " << stats.getStdDev()
+        << ", min " << stats.getMin() << ", p5 " << ensemble.percentile(field, 0.05)
+        << ", p50 " << ensemble.percentile(field, 0.5) << ", p95 " << ensemble.percentile(field, 0.95)
+        << ", max " << stats.getMax() << std::endl;
+}
+
+static int runEnsemble(const SimulationConfig& config, size_t runs, long long ticks)
+{
+    EnsembleConfig ensembleConfig;
+    ensembleConfig.scenario = config;
+    ensembleConfig.runs = runs;
+    ensembleConfig.ticks = ticks;
+    ensembleConfig.threads = config.threads;
+    ensembleConfig.reportEvery = std::max<size_t>(1, runs / 10);
+
+    Ensemble ensemble(ensembleConfig);
+
+    auto start = std::chrono::steady_clock::now();
+
+    ensemble.run([](const EnsembleStats& stats) {
+        std::cout << "  " << stats.runs << " runs, mean final mid " << stats.finalMid.getMean()
+            << ", mean max drawdown " << stats.maxDrawdown.getMean() << std::endl;
+    });
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double seconds = elapsed.count();
+
+    const EnsembleStats& stats = ensemble.getStats();
+
+    std::cout << "Ran " << runs << " runs of " << ticks << " ticks in " << seconds << " s" << std::endl;
+    std::cout << "  base seed:    " << config.seed << " (run i uses seed + i)" << std::endl;
+    std::cout << "  runs/sec:     " << runs / seconds << std::endl;
+    printStats("final mid:   ", stats.finalMid, ensemble, &RunSummary::finalMid);
+    printStats("max drawdown:", stats.maxDrawdown, ensemble, &RunSummary::maxDrawdown);
+    printStats("volume:      ", stats.tradedVolume, ensemble, &RunSummary::tradedVolume);
+
+    return 0;
+}
+
+static int runReplay(const std::string& path)
+{
+    auto start = std::chrono::steady_clock::now();
+    ReplayResult result = replayJournal(path);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double seconds = elapsed.count();
+
+    if (!result.opened)
+    {
+        std::cout << "Error reading journal " << path << std::endl;
+        return 1;
+    }
+
+    size_t commands = result.orders + result.cancels + result.amends + result.stops;
+
+    std::cout << "Replayed " << commands << " commands in " << seconds << " s" << std::endl;
+    std::cout << "  commands/sec: " << commands / seconds << " (" << result.orders << " orders, " << result.cancels << " cancels, " << result.amends << " amends, " << result.stops << " stops)" << std::endl;
+    std::cout << "  trades/sec:   " << result.trades / seconds << " (" << result.trades << " trades)" << std::endl;
+    std::cout << "  mismatches:   " << result.mismatches << std::endl;
+
+    return result.mismatches == 0 ? 0 : 2;
+}
+
+static void writeProfile(const std::string& path)
+{
+    if (path.empty()) return;
+
+    if (!Profiler::enabled) std::cout << "--profile needs a build with -DMARKETSIM_PROFILE=ON" << std::endl;
+    else if (Profiler::writeReport(path)) std::cout << "  profile:    " << path << std::endl;
+    else std::cout << "Error writing latency report " << path << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    long long ticks = 100000;
+    SimulationConfig config;
+    config.seed = std::random_device{}();
+    std::string journalPath;
+    std::string exportPath;
+    std::string profilePath;
+    std::string restorePath;
+    std::string checkpointPath;
+    size_t symbols = 0;
+    size_t runs = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+
+        if (std::strcmp(argv[i], "--ticks") == 0 && hasValue) ticks = std::stoll(argv[++i]);
+        else if (std::strcmp(argv[i], "--trend") == 0 && hasValue) config.trendTraders = std::stoul(argv[++i]);
+        else if (std::strcmp(argv[i], "--random") == 0 && hasValue) config.randomTraders = std::stoul(argv[++i]);
+        else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) config.seed = std::stoull(argv[++i]);
+        else if (std::strcmp(argv[i], "--parallel") == 0) config.parallelDecide = true;
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) config.threads = std::stoul(argv[++i]);
+        else if (std::strcmp(argv[i], "--journal") == 0 && hasValue) journalPath = argv[++i];
+        else if (std::strcmp(argv[i], "--symbols") == 0 && hasValue) symbols = std::stoul(argv[++i]);
+        else if (std::strcmp(argv[i], "--runs") == 0 && hasValue) runs = std::stoul(argv[++i]);
+        else if (std::strcmp(argv[i], "--retain") == 0 && hasValue) config.tradeRetention = config.midPriceRetention = std::stoul(argv[++i]);
+        else if (std::strcmp(argv[i], "--export") == 0 && hasValue) exportPath = argv[++i];
+        else if (std::strcmp(argv[i], "--trend-wake") == 0 && hasValue) config.trendWakeInterval = std::stoll(argv[++i]);
+        else if (std::strcmp(argv[i], "--random-wake") == 0 && hasValue) config.randomWakeInterval = std::stoll(argv[++i]);
+        else if (std::strcmp(argv[i], "--latency") == 0 && hasValue) config.orderLatency = std::stoll(argv[++i]);
+        else if (std::strcmp(argv[i], "--profile") == 0 && hasValue) profilePath = argv[++i];
+        else if (std::strcmp(argv[i], "--restore") == 0 && hasValue) restorePath = argv[++i];
+        else if (std::strcmp(argv[i], "--checkpoint") == 0 && hasValue) checkpointPath = argv[++i];
+        else if (std::strcmp(argv[i], "--replay") == 0 && hasValue) return runReplay(argv[++i]);
+        else if (std::strcmp(argv[i], "--to-csv") == 0 && i + 2 < argc)
+        {
+            if (convertMarketDataToCsv(argv[i + 1], argv[i + 2])) return 0;
+            std::cout << "Error converting " << argv[i + 1] << std::endl;
+            return 1;
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (runs > 0)
+    {
+        if (!journalPath.empty() || !exportPath.empty() || symbols > 0 || !restorePath.empty() || !checkpointPath.empty())
+        {
+            std::cout << "--runs can't be combined with --journal, --export, --symbols, --restore or --checkpoint" << std::endl;
+            return 1;
+        }
+        int result = runEnsemble(config, runs, ticks);
+        writeProfile(profilePath);
+        return result;
+    }
+
+    if (symbols > 0)
+    {
+        if (!journalPath.empty() || !exportPath.empty() || !restorePath.empty() || !checkpointPath.empty())
+        {
+            std::cout << "--journal, --export, --restore and --checkpoint only work on the single book run" << std::endl;
+            return 1;
+        }
+        if (config.trendWakeInterval > 0 || config.randomWakeInterval > 0 || config.orderLatency > 0)
+        {
+            std::cout << "--trend-wake, --random-wake and --latency need the event scheduler of the single book run" << std::endl;
+            return 1;
+        }
+        int result = runExchange(config, symbols, ticks);
+        writeProfile(profilePath);
+        return result;
+    }
+
+    Simulation sim(config);
+    const LimitOrderBook& LOB = sim.getBook();
+
+    if (!restorePath.empty())
+    {
+        //A journal replays from an empty book, it can't start from a restored one
+        if (!journalPath.empty())
+        {
+            std::cout << "--journal can't be combined with --restore" << std::endl;
+            return 1;
+        }
+
+        auto restoreStart = std::chrono::steady_clock::now();
+        std::string error;
+        if (!sim.loadCheckpoint(restorePath, &error))
+        {
+            std::cout << "Error restoring checkpoint " << restorePath << ": " << error << std::endl;
+            return 1;
+        }
+        std::chrono::duration<double, std::milli> restoreTime = std::chrono::steady_clock::now() - restoreStart;
+        std::cout << "Restored " << restorePath << " at tick " << sim.getClock().now() << " in " << restoreTime.count() << " ms" << std::endl;
+    }
+
+    JournalWriter journal;
+    if (!journalPath.empty())
+    {
+        if (!journal.open(journalPath))
+        {
+            std::cout << "Error opening journal " << journalPath << std::endl;
+            return 1;
+        }
+        sim.setJournal(&journal);
+    }
+
+    MarketDataWriter marketData;
+    if (!exportPath.empty())
+    {
+        if (!marketData.open(exportPath))
+        {
+            std::cout << "Error opening export file " << exportPath << std::endl;
+            return 1;
+        }
+        sim.setMarketDataWriter(&marketData);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    sim.runUntil(sim.getClock().now() + ticks * config.dt);
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double seconds = elapsed.count();
+
+    //Same seed and mode give the same checksum (over the retained trades with --retain)
+    uint64_t checksum = 1469598103934665603ULL;
+    for (const TradeRecord& trade : LOB.getTradeHistory())
+    {
+        uint64_t fields[] = { trade.tradeId, static_cast<uint64_t>(trade.price), static_cast<uint64_t>(trade.volume), trade.buyerId, trade.sellerId, trade.timeStamp };
+        for (uint64_t field : fields) checksum = (checksum ^ field) * 1099511628211ULL;
+    }
+
+    std::cout << "Ran " << ticks << " ticks with " << sim.getTraderCount() << " traders in " << seconds << " s"
+        << (config.parallelDecide ? " (parallel decide)" : "") << std::endl;
+    std::cout << "  seed:       " << config.seed << std::endl;
+    std::cout << "  ticks/sec:  " << ticks / seconds << std::endl;
+    std::cout << "  orders/sec: " << LOB.getOrderCount() / seconds << " (" << LOB.getOrderCount() << " orders)" << std::endl;
+    std::cout << "  trades/sec: " << LOB.getTradeCount() / seconds << " (" << LOB.getTradeCount() << " trades)" << std::endl;
+
+    std::cout << "  stops:      " << LOB.getFiredStopCount(BUY) << " buy and " << LOB.getFiredStopCount(SELL) << " sell fired, " << LOB.getStopCount() << " waiting" << std::endl;
+
+    if (!LOB.getMidPriceHistory().empty())
+    {
+        std::cout << "  final mid:  " << LOB.getMidPriceHistory().back() << std::endl;
+    }
+
+    std::cout << "  checksum:   " << std::hex << checksum << std::dec << std::endl;
+
+    if (marketData.isOpen())
+    {
+        marketData.close();
+        std::cout << "  exported:   " << exportPath << (marketData.getDropped() > 0 ? " (" + std::to_string(marketData.getDropped()) + " records dropped)" : "") << std::endl;
+    }
+
+    if (!checkpointPath.empty())
+    {
+        if (sim.saveCheckpoint(checkpointPath)) std::cout << "  checkpoint: " << checkpointPath << std::endl;
+        else
+        {
+            std::cout << "Error writing checkpoint " << checkpointPath << std::endl;
+            return 1;
+        }
+    }
+
+    writeProfile(profilePath);
+
+    return 0;
+}
\ No newline at end of file
@@ -1,5 +1,9 @@
 #include <iostream>
 #include <vector>
+#include <random>
+#include <string>
+#include <cstring>
+#include <algorithm>
 #include <SFML/Graphics/RenderWindow.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
 #include <SFML/Graphics/Font.hpp>
@@ -8,18 +12,50 @@
 #include <SFML/Window/WindowEnums.hpp>
 #include <SFML/Window/Event.hpp>
 
-#include "Clock.h"
 #include "datatypes.h"
 #include "UIHelpers.h"
-#include "LimitOrderBook.h"
 #include "LOBPanel.h"
 #include "DepthChart.h"
-#include "Trader.h"
-#include "TrendStrategy.h"
-#include "RandomStrategy.h"
+#include "SimulationThread.h"
+#include "ProfilerOverlay.h"
+#include "Profiler.h"
 
-int main()
+static std::string statusLine(const SimulationThread& sim, const BookSnapshot& snapshot, const std::string& typedTick)
 {
+    std::string status = "tick " + std::to_string(snapshot.time);
+
+    if (snapshot.time < sim.getSkipTarget()) status += "  skipping to " + std::to_string(sim.getSkipTarget());
+    else if (sim.getSpeed() <= 0.0) status += "  flat out";
+    else status += "  " + std::to_string(static_cast<long long>(sim.getSpeed())) + " steps/s";
+
+    if (!typedTick.empty()) status += "  go to " + typedTick + "_";
+    return status;
+}
+
+int main(int argc, char** argv)
+{
+    double updatesPerSecond = 10.0;
+    long long skipTo = 0;
+    std::string profilePath = "profile.txt";
+    std::string checkpointPath = "checkpoint.bin";
+    std::string restorePath;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+
+        if (std::strcmp(argv[i], "--speed") == 0 && hasValue) updatesPerSecond = std::stod(argv[++i]);
+        else if (std::strcmp(argv[i], "--skip-to") == 0 && hasValue) skipTo = std::stoll(argv[++i]);
+        else if (std::strcmp(argv[i], "--profile") == 0 && hasValue) profilePath = argv[++i];
+        else if (std::strcmp(argv[i], "--checkpoint") == 0 && hasValue) checkpointPath = argv[++i];
+        else if (std::strcmp(argv[i], "--restore") == 0 && hasValue) restorePath = argv[++i];
+        else
+        {
+            std::cout << "Usage: " << argv[0] << " [--speed STEPS_PER_SEC (0 = flat out)] [--skip-to TICK] [--profile FILE] [--checkpoint FILE] [--restore FILE]" << std::endl;
+            return 1;
+        }
+    }
+
     auto window = sf::RenderWindow(sf::VideoMode({1920u, 1080u}), "Market simulator", sf::State::Fullscreen);
     window.setFramerateLimit(144);
 
@@ -29,44 +65,29 @@ int main()
         std::cout << "Error loading font!" << std::endl;
     }
 
-    Clock clock;
+    LOBPanel lobPanel;
+    DepthChart depthChart;
 
-    double dt = 1.0; //Ticks per update
+    SimulationConfig config;
+    config.seed = std::random_device{}();
 
-    double updatesPerSecond = 10.0;
-    double realDt = 1.0 / updatesPerSecond;
-    auto lastTime = std::chrono::high_resolution_clock::now();
+    //Steps on its own thread, the loop below only draws the newest snapshot
+    SimulationThread sim(config, updatesPerSecond);
+    if (!restorePath.empty()) sim.requestLoad(restorePath);
+    sim.skipTo(skipTo);
 
-    LOBPanel lobPanel;
+    //Up/Down double or halve the pace, F toggles flat out, digits then Enter skip to that tick,
+    //P shows the latency histograms, C saves a checkpoint and L goes back to it
+    double pacedSpeed = updatesPerSecond > 0.0 ? updatesPerSecond : 10.0;
+    std::string typedTick;
 
-    LimitOrderBook LOB;
-    DepthChart depthChart;
+    ProfilerOverlay profilerOverlay;
+    bool showProfiler = false;
 
     float lobWidth = static_cast<float>(window.getSize().x * 0.25f);
     float chartWidth = static_cast<float>(window.getSize().x * 0.25f);
     float chartHeight = static_cast<float>(window.getSize().y * 0.25f);
 
-    bool lobDirty = true;
-
-
-    TrendStrategy* trendStrat = new TrendStrategy();
-    std::vector<Trader> trendTraders;
-    trendTraders.reserve(10);
-    for (int i = 0; i < 5; i++) {
-        trendTraders.emplace_back(trendStrat, i, 2000.0, 100L);
-    }
-    for (auto& t : trendTraders) LOB.registerTrader(&t);
-
-    RandomStrategy* randomStrat = new RandomStrategy();
-    std::vector<Trader> randomTraders;
-    randomTraders.reserve(20);
-    for (int i = 0; i < 10; i++) {
-        randomTraders.emplace_back(randomStrat, i + 5, 2000.0, 100L);
-    }
-    for (auto& t : randomTraders) LOB.registerTrader(&t);
-
-    LOB.registerTrader(new Trader{randomStrat, 999, 100000.0, 20000L});
-
     while (window.isOpen())
     {
         while (const std::optional event = window.pollEvent())
@@ -76,53 +97,77 @@ int main()
                 window.close();
             }
 
+            if (const auto* textEntered = event->getIf<sf::Event::TextEntered>()) {
+                if (textEntered->unicode >= U'0' && textEntered->unicode <= U'9' && typedTick.size() < 12) typedTick += static_cast<char>(textEntered->unicode);
+            }
+
             if (const auto* keyPressed = event->getIf<sf::Event::KeyPressed>()) {
-                if (keyPressed->code == sf::Keyboard::Key::Escape) window.close();
+                switch (keyPressed->code)
+                {
+                case sf::Keyboard::Key::Escape:
+                    if (typedTick.empty()) window.close();
+                    typedTick.clear();
+                    break;
+                case sf::Keyboard::Key::Backspace:
+                    if (!typedTick.empty()) typedTick.pop_back();
+                    break;
+                case sf::Keyboard::Key::Enter:
+                    if (!typedTick.empty()) sim.skipTo(std::stoll(typedTick));
+                    typedTick.clear();
+                    break;
+                case sf::Keyboard::Key::Up:
+                    pacedSpeed = std::min(pacedSpeed * 2.0, 1e6);
+                    sim.setSpeed(pacedSpeed);
+                    break;
+                case sf::Keyboard::Key::Down:
+                    pacedSpeed = std::max(pacedSpeed / 2.0, 1.0);
+                    sim.setSpeed(pacedSpeed);
+                    break;
+                case sf::Keyboard::Key::F:
+                    sim.setSpeed(sim.getSpeed() > 0.0 ? 0.0 : pacedSpeed);
+                    break;
+                case sf::Keyboard::Key::P:
+                    showProfiler = !showProfiler;
+                    break;
+                case sf::Keyboard::Key::C:
+                    sim.requestSave(checkpointPath);
+                    break;
+                case sf::Keyboard::Key::L:
+                    sim.requestLoad(checkpointPath);
+                    break;
+                default:
+                    break;
+                }
             }
         }
 
-        auto now = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> elapsed = now - lastTime;
+        std::string checkpointResult;
+        if (sim.takeCheckpointResult(checkpointResult)) std::cout << checkpointResult << std::endl;
 
-        while (elapsed.count() >= realDt)
-        {
-            clock.advance(dt);
-            lastTime += std::chrono::duration_cast<
-                std::chrono::high_resolution_clock::duration>(
-                    std::chrono::duration<double>(realDt)
-                );
-            elapsed = now - lastTime;
-        
-            LOB.update();
-
-            if (clock.now() == 30) {
-                Order whalePanic = { 999, 999, 10.0, 2000, Side::SELL, clock.now() };
-                LOB.processOrder(whalePanic, clock);
-            }
-        
-            for (size_t i = 0; i < 10; i++)
-            {
-                randomTraders[i].update(LOB, clock);
-            }
-            
-            for (size_t i = 0; i < 5; i++)
-            {
-                trendTraders[i].update(LOB, clock);
-            }
-        
-            lobDirty = true;
-        }
+        sim.update();
+        const BookSnapshot& snapshot = sim.getSnapshot();
 
         window.clear(Theme::Background);
 
-        if (lobDirty)
+        depthChart.update(snapshot, chartWidth, chartHeight, window.getSize());
+
+        lobPanel.draw(window, font, snapshot, lobWidth);
+        window.draw(depthChart);
+        UIHelper::drawLabel(window, font, statusLine(sim, snapshot, typedTick), 16, static_cast<float>(window.getSize().x), 10.f, TextSnap::Right, -10.f, Theme::TextDim);
+
+        if (showProfiler)
         {
-            depthChart.update(LOB, chartWidth, chartHeight, window.getSize());
-            lobDirty = false;
+            profilerOverlay.update(font, static_cast<float>(window.getSize().x) - 10.f, 40.f);
+            window.draw(profilerOverlay);
         }
 
-        lobPanel.draw(window, font, LOB, lobWidth);
-        window.draw(depthChart);
         window.display();
     }
+
+    //Latency report of the whole session, profiling builds only
+    if (Profiler::enabled)
+    {
+        if (Profiler::writeReport(profilePath)) std::cout << "Latency report written to " << profilePath << std::endl;
+        else std::cout << "Error writing latency report " << profilePath << std::endl;
+    }
 }
\ No newline at end of file
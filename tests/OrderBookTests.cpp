@@ -0,0 +1,276 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <map>
+#include <random>
+
+#include "LimitOrderBook.h"
+#include "Clock.h"
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& what)
+{
+    if (condition) return;
+
+    std::cout << "FAIL: " << what << std::endl;
+    failures++;
+}
+
+//Walks a side best first, stopping after limit levels so a walk that never ends fails instead of hanging
+template<class Levels>
+static std::vector<Ticks> walk(const Levels& levels, size_t limit = 64)
+{
+    std::vector<Ticks> prices;
+    for (auto it = levels.begin(); it != levels.end(); ++it) {
+        if (prices.size() == limit) break;
+        prices.push_back(it->price);
+    }
+    return prices;
+}
+
+static std::vector<Ticks> prices(std::initializer_list<double> values)
+{
+    std::vector<Ticks> ticks;
+    for (double value : values) ticks.push_back(toTicks(value));
+    return ticks;
+}
+
+static std::vector<Ticks> topPrices(const LimitOrderBook& LOB, Side side)
+{
+    std::vector<Ticks> ticks;
+    for (const LevelInfo& level : LOB.getTopLevels(side, 64)) ticks.push_back(level.price);
+    return ticks;
+}
+
+//Levels far enough from the rest of their side to sit outside the price ladder's window,
+//on both sides of it, have to come out of every walk in price order
+static void testOutlierLevels()
+{
+    LimitOrderBook LOB;
+    Clock clock;
+
+    OrderId bidNear = LOB.processOrder(makeOrder(1, BUY, 3000.00, 5, 0), clock);
+    LOB.processOrder(makeOrder(1, BUY, 2999.99, 3, 0), clock);
+    OrderId bidFar = LOB.processOrder(makeOrder(1, BUY, 5000.00, 7, 0), clock);
+    OrderId bidLow = LOB.processOrder(makeOrder(1, BUY, 1.00, 11, 0), clock);
+
+    LOB.processOrder(makeOrder(2, SELL, 8000.00, 4, 0), clock);
+    LOB.processOrder(makeOrder(2, SELL, 8000.01, 6, 0), clock);
+    OrderId askFar = LOB.processOrder(makeOrder(2, SELL, 6000.00, 2, 0), clock);
+    OrderId askHigh = LOB.processOrder(makeOrder(2, SELL, 10000.00, 9, 0), clock);
+
+    std::vector<Ticks> bids = prices({ 5000.00, 3000.00, 2999.99, 1.00 });
+    std::vector<Ticks> asks = prices({ 6000.00, 8000.00, 8000.01, 10000.00 });
+
+    check(walk(LOB.getBids()) == bids, "bid walk is best first and ends");
+    check(walk(LOB.getAsks()) == asks, "ask walk is best first and ends");
+    check(topPrices(LOB, BUY) == bids, "getTopLevels(BUY) matches the walk");
+    check(topPrices(LOB, SELL) == asks, "getTopLevels(SELL) matches the walk");
+
+    check(LOB.getHighestVolume(BUY, 2) == 7, "getHighestVolume(BUY, 2)");
+    check(LOB.getHighestVolume(BUY, 10) == 11, "getHighestVolume(BUY, 10)");
+    check(LOB.getHighestVolume(SELL, 10) == 9, "getHighestVolume(SELL, 10)");
+    check(LOB.getCumulativeDepth(BUY, toTicks(2999.99)) == 15, "getCumulativeDepth(BUY, 2999.99)");
+    check(LOB.getCumulativeDepth(BUY, toTicks(1.00)) == 26, "getCumulativeDepth(BUY, 1.00)");
+    check(LOB.getCumulativeDepth(SELL, toTicks(8000.01)) == 12, "getCumulativeDepth(SELL, 8000.01)");
+
+    long totalVolume = 0;
+    std::vector<DepthPoint> points = LOB.depthChartPoints(0.01f, &totalVolume);
+    check(points.size() == bids.size() + asks.size() + 1, "depthChartPoints has a point per level and the mid");
+    check(!points.empty() && points.front().totalVolume == 26 && points.back().totalVolume == 21, "depthChartPoints runs out to the far outliers");
+
+    //A checkpoint writes the queues by walking the levels, so a restored book has them all
+    const std::string path = "orderbook_tests.ckpt";
+    {
+        CheckpointWriter writer;
+        check(writer.open(path), "checkpoint opens for writing");
+        LOB.saveState(writer);
+        check(writer.close(), "checkpoint writes");
+    }
+    {
+        LimitOrderBook restored;
+        CheckpointReader reader;
+        check(reader.open(path) && restored.loadState(reader), "checkpoint loads");
+        check(topPrices(restored, BUY) == bids && topPrices(restored, SELL) == asks, "restored book has every level");
+    }
+    std::remove(path.c_str());
+
+    //The walk has to drop back to the window once the last outlier is passed
+    LOB.cancelOrder(bidLow);
+    LOB.cancelOrder(askHigh);
+    check(walk(LOB.getBids()) == prices({ 5000.00, 3000.00, 2999.99 }), "bid walk ending in the window");
+    check(walk(LOB.getAsks()) == prices({ 6000.00, 8000.00, 8000.01 }), "ask walk ending in the window");
+    check(LOB.getCumulativeDepth(BUY, toTicks(1.00)) == 15, "getCumulativeDepth(BUY) ending in the window");
+
+    //Window only, then nothing
+    LOB.cancelOrder(bidFar);
+    LOB.cancelOrder(askFar);
+    check(walk(LOB.getBids()) == prices({ 3000.00, 2999.99 }), "bid walk without outliers");
+    check(walk(LOB.getAsks()) == prices({ 8000.00, 8000.01 }), "ask walk without outliers");
+
+    LOB.cancelOrder(bidNear);
+    LOB.processOrder(makeOrder(2, SELL, 2999.99, 3, 0), clock);
+    check(walk(LOB.getBids()).empty(), "bid walk of an empty side");
+}
+
+//Rebuilds both sides from nothing but the book's level deltas
+class ShadowBook : public BookListener
+{
+public:
+    std::map<Ticks, LevelInfo> levels[2];
+    size_t trades = 0;
+    size_t badDeltas = 0; //Adds of a level already there, changes or removals of one that isn't
+
+    void onLevel(const LevelDelta& delta) override
+    {
+        std::map<Ticks, LevelInfo>& side = levels[delta.side];
+        bool known = side.count(delta.price) > 0;
+
+        if (delta.change == LevelChange::Removed) {
+            if (!known) badDeltas++;
+            side.erase(delta.price);
+            return;
+        }
+
+        if ((delta.change == LevelChange::Added) == known) badDeltas++;
+        side[delta.price] = { delta.price, delta.volume, delta.orderCount };
+    }
+
+    void onTrade(const TradeRecord& trade) override
+    {
+        (void)trade;
+        trades++;
+    }
+
+    bool matches(const LimitOrderBook& LOB, Side side) const
+    {
+        std::vector<LevelInfo> top = LOB.getTopLevels(side, levels[side].size() + 1);
+        if (top.size() != levels[side].size()) return false;
+
+        for (const LevelInfo& level : top) {
+            auto it = levels[side].find(level.price);
+            if (it == levels[side].end() || it->second.volume != level.volume || it->second.orderCount != level.orderCount) return false;
+        }
+        return true;
+    }
+};
+
+//Replaying the L2 feed has to give the book's own levels after any mix of operations
+static void testLevelDeltas()
+{
+    LimitOrderBook LOB;
+    ShadowBook shadow;
+    LOB.addListener(&shadow);
+    Clock clock;
+
+    std::mt19937 rng(7);
+    auto pick = [&](int n) { return static_cast<int>(rng() % static_cast<unsigned>(n)); };
+    auto price = [&] { return 19.50 + pick(100) * 0.01; };
+    auto side = [&] { return pick(2) ? BUY : SELL; };
+
+    std::vector<OrderId> ids;
+    std::vector<Command> batch;
+    std::vector<CommandResult> results;
+    size_t mismatches = 0;
+
+    for (int i = 0; i < 50000; i++)
+    {
+        clock.advance(1);
+        TraderId trader = 1 + pick(8);
+
+        switch (pick(8))
+        {
+        case 0: { //Sweep
+            Side s = side();
+            ids.push_back(LOB.processOrder(makeOrder(trader, s, s == BUY ? 21.00 : 19.00, 50 + pick(200), clock.now()), clock));
+            break;
+        }
+        case 1:
+            if (!ids.empty()) {
+                size_t k = pick(static_cast<int>(ids.size()));
+                LOB.cancelOrder(ids[k]);
+                ids[k] = ids.back();
+                ids.pop_back();
+            }
+            break;
+        case 2:
+            if (!ids.empty()) LOB.amendOrder(ids[pick(static_cast<int>(ids.size()))], toTicks(price()), pick(60) - 5, clock);
+            break;
+        case 3: {
+            double mid = price();
+            LOB.massQuote(trader, makeOrder(trader, BUY, mid - 0.01 * pick(3), pick(20), clock.now()), makeOrder(trader, SELL, mid + 0.01 * pick(3), pick(20), clock.now()), clock);
+            break;
+        }
+        case 4: {
+            Side s = side();
+            double trigger = price();
+            ids.push_back(LOB.placeStop(makeOrder(trader, s, pick(2) ? 0.0 : trigger, 1 + pick(30), clock.now()), toTicks(trigger), pick(2) ? StopKind::Limit : StopKind::Market, clock));
+            break;
+        }
+        case 5: {
+            batch.clear();
+            for (int n = pick(6); n >= 0; n--) {
+                if (!ids.empty() && pick(3) == 0) batch.push_back(makeCancelCommand(ids[pick(static_cast<int>(ids.size()))]));
+                else batch.push_back(makeOrderCommand(makeOrder(trader, side(), price(), 1 + pick(40), clock.now()), false));
+            }
+            results.resize(batch.size());
+            LOB.processBatch(batch.data(), batch.size(), results.data(), clock);
+            break;
+        }
+        default:
+            ids.push_back(LOB.processOrder(makeOrder(trader, side(), price(), 1 + pick(50), clock.now()), clock));
+            break;
+        }
+
+        if (i % 101 == 0 && !(shadow.matches(LOB, BUY) && shadow.matches(LOB, SELL))) mismatches++;
+    }
+
+    check(mismatches == 0 && shadow.matches(LOB, BUY) && shadow.matches(LOB, SELL), "levels rebuilt from deltas match getTopLevels");
+    check(shadow.badDeltas == 0, "every delta's change fits the level it names");
+    check(shadow.trades == LOB.getTradeCount() && shadow.trades > 0, "every trade reaches the listener");
+}
+
+//One order that fills more trades than a history chunk holds still replays without mismatches
+static void testJournalLongSweep()
+{
+    const std::string path = "orderbook_tests.journal";
+    const int fills = 10000;
+
+    {
+        JournalWriter journal;
+        check(journal.open(path), "journal opens for writing");
+
+        LimitOrderBook LOB;
+        LOB.setJournal(&journal);
+        Clock clock;
+
+        for (int i = 0; i < fills; i++) LOB.processOrder(makeOrder(1, SELL, 20.00 + (i % 50) * 0.01, 1, 0), clock);
+        clock.advance(1);
+        LOB.processOrder(makeOrder(2, BUY, 21.00, fills, clock.now()), clock);
+        LOB.processOrder(makeOrder(3, SELL, 19.00, 1, clock.now()), clock);
+
+        journal.close();
+        check(LOB.getTradeCount() == static_cast<size_t>(fills), "the sweep fills every resting order");
+    }
+
+    ReplayResult replay = replayJournal(path);
+    check(replay.opened && replay.trades == static_cast<size_t>(fills) && replay.mismatches == 0, "a long sweep replays without mismatches");
+    std::remove(path.c_str());
+}
+
+int main()
+{
+    testOutlierLevels();
+    testLevelDeltas();
+    testJournalLongSweep();
+
+    if (failures > 0) {
+        std::cout << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
\ No newline at end of file
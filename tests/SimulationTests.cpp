@@ -0,0 +1,56 @@
+#include <iostream>
+#include <string>
+
+#include "Simulation.h"
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& what)
+{
+    if (condition) return;
+
+    std::cout << "FAIL: " << what << std::endl;
+    failures++;
+}
+
+//Trend traders only trade through their breakout stops (and cash-out sells), so in the
+//default scenario both kinds of stop have to fire and trend traders have to show up on
+//both sides of the tape. Seed 3 over 20000 ticks fires 581 buy and 91 sell stops, and
+//trend traders buy in 110 of its 435 trades and sell in 12.
+static void testTrendStopsTrade()
+{
+    SimulationConfig config;
+    config.seed = 3;
+
+    Simulation sim(config);
+    sim.runUntil(20000);
+
+    const LimitOrderBook& LOB = sim.getBook();
+    TraderId firstRandom = static_cast<TraderId>(config.trendTraders); //Trend traders take the first ids
+
+    size_t trendBuys = 0;
+    size_t trendSells = 0;
+    for (const TradeRecord& trade : LOB.getTradeHistory()) {
+        if (trade.buyerId < firstRandom) trendBuys++;
+        if (trade.sellerId < firstRandom) trendSells++;
+    }
+
+    check(LOB.getFiredStopCount(BUY) > 0, "trend buy stops fire");
+    check(LOB.getFiredStopCount(SELL) > 0, "trend sell stops fire");
+    check(trendBuys > 0, "trend traders buy");
+    check(trendSells > 0, "trend traders sell");
+    check(LOB.getStopCount() <= 2 * config.trendTraders, "each trend trader keeps at most one stop per side waiting");
+}
+
+int main()
+{
+    testTrendStopsTrade();
+
+    if (failures > 0) {
+        std::cout << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "All checks passed" << std::endl;
+    return 0;
+}
\ No newline at end of file